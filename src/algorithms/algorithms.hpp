@@ -0,0 +1,5 @@
+#pragma once
+#include "compare.hpp"
+#include "radix_sort.hpp"
+#include "search.hpp"
+#include "sort.hpp"
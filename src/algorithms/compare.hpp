@@ -0,0 +1,54 @@
+#pragma once
+#include <concepts>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <orc_export.hpp>
+#include <ordefs.hpp>
+
+#include "cmp.hpp"
+#include "vector.hpp"
+
+using namespace orc::core::defines;
+
+namespace orc::algorithms {
+
+    /// `(a, b) -> cmp::ordering`, the comparator protocol of every algorithm
+    template<typename C, typename A, typename B = A>
+    concept comparator = std::invocable<const C&, const A&, const B&> &&
+        std::same_as<std::invoke_result_t<const C&, const A&, const B&>, utils::cmp::ordering>;
+
+    /// order given by `cmp::cmp`, the default of every algorithm
+    struct ORC_API natural_order {
+        template<typename T>
+        [[nodiscard]] constexpr auto operator()(const T& left, const T& right) const -> utils::cmp::ordering {
+            return utils::cmp::cmp(left, right);
+        }
+    };
+
+    /// strict weak "less" derived from a comparator
+    template<typename C>
+    struct _less {
+        const C& c;
+        template<typename A, typename B>
+        [[nodiscard]] constexpr auto operator()(const A& left, const B& right) const -> bool {
+            return c(left, right) == utils::cmp::ordering::Less;
+        }
+    };
+    /// `cmp::cmp` is constexpr and starts with `<`, so it collapses to a single comparison the optimizer can turn into a select
+    template<>
+    struct _less<natural_order> {
+        const natural_order& c;
+        template<typename A, typename B>
+        [[nodiscard]] constexpr auto operator()(const A& left, const B& right) const -> bool { return left < right; }
+    };
+
+    /// element types which compare and move as cheaply as integers, partitioned without branches
+    template<typename T, typename C>
+    inline constexpr bool _branchless = std::is_same_v<C, natural_order> && std::is_trivially_copyable_v<T> && sizeof(T) <= 16;
+
+    template<typename T, class Alloc>
+    [[nodiscard]] constexpr auto _as_span(containers::vector<T, Alloc>& vec) noexcept -> std::span<T> { return vec.as_span(); }
+    template<typename T, class Alloc>
+    [[nodiscard]] constexpr auto _as_span(const containers::vector<T, Alloc>& vec) noexcept -> std::span<const T> { return vec.as_span(); }
+}
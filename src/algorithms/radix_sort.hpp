@@ -0,0 +1,124 @@
+#pragma once
+#include <array>
+#include <concepts>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <orc_export.hpp>
+#include <ordefs.hpp>
+
+#include "compare.hpp"
+#include "redtime.hpp"
+#include "rfloat.hpp"
+#include "sort.hpp"
+
+using namespace orc::core::defines;
+
+namespace orc::algorithms {
+
+    /// `static constexpr auto get(const T&) -> unsigned integer` whose unsigned order is the order of `T`
+    template<typename T>
+    struct radix_key;
+
+    template<std::unsigned_integral T>
+    struct ORC_API radix_key<T> {
+        [[nodiscard]] static constexpr auto get(const T value) noexcept -> T { return value; }
+    };
+    template<std::signed_integral T>
+    struct ORC_API radix_key<T> {
+        /// flipping the sign bit maps two's complement order onto unsigned order
+        [[nodiscard]] static constexpr auto get(const T value) noexcept -> std::make_unsigned_t<T> {
+            using U = std::make_unsigned_t<T>;
+            return static_cast<U>(value) ^ (U{1} << (sizeof(T) * 8 - 1));
+        }
+    };
+    template<>
+    struct ORC_API radix_key<time::time> {
+        [[nodiscard]] static constexpr auto get(const time::time value) noexcept -> u64 { return radix_key<i64>::get(value.raw_value()); }
+    };
+    template<>
+    struct ORC_API radix_key<floating::rfloat> {
+        [[nodiscard]] static constexpr auto get(const floating::rfloat value) noexcept -> u64 { return radix_key<i64>::get(value.raw()); }
+    };
+
+    template<typename T>
+    concept radix_sortable = requires(const T& value) { { radix_key<T>::get(value) } -> std::unsigned_integral; };
+
+    template<radix_sortable T>
+    using _radix_key_t = decltype(radix_key<T>::get(std::declval<const T&>()));
+
+    /// below this size comparison sorting beats the histogram passes
+    inline constexpr usize _RADIX_THRESHOLD = 256;
+
+    /// lsd radix sort over bytes, stable. passes where every key has the same byte are skipped,
+    /// so narrow key ranges such as timestamps of one batch cost only a few passes
+    template<typename Item, typename K>
+    auto _lsd_sort(Item* data, Item* scratch, const usize n, const K& key) -> void {
+        using U = std::remove_cvref_t<decltype(key(*data))>;
+        constexpr usize DIGITS = sizeof(U);
+        std::vector<std::array<usize, 256>> counts(DIGITS);
+        for (usize i = 0; i < n; ++i) {
+            const U k = key(data[i]);
+            for (usize d = 0; d < DIGITS; ++d) counts[d][(k >> (d * 8)) & 0xFF]++;
+        }
+        Item* from = data;
+        Item* to = scratch;
+        const U first_key = key(data[0]);
+        for (usize d = 0; d < DIGITS; ++d) {
+            auto& count = counts[d];
+            if (count[(first_key >> (d * 8)) & 0xFF] == n) continue;
+            usize offset = 0;
+            for (auto& c : count) offset += std::exchange(c, offset);
+            for (usize i = 0; i < n; ++i) to[count[(key(from[i]) >> (d * 8)) & 0xFF]++] = std::move(from[i]);
+            std::swap(from, to);
+        }
+        if (from != data) std::move(from, from + n, data);
+    }
+
+    /// stable sort of integers, `time` or `rfloat` (or anything with a `radix_key`) in O(n * key bytes)
+    template<radix_sortable T>
+    requires std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T>
+    ORC_API auto radix_sort(const std::span<T> values) -> void {
+        if (values.size() < _RADIX_THRESHOLD) {
+            algorithms::stable_sort(values, [](const T& l, const T& r) { return utils::cmp::cmp(radix_key<T>::get(l), radix_key<T>::get(r)); });
+            return;
+        }
+        std::vector<T> scratch(values.size());
+        _lsd_sort(values.data(), scratch.data(), values.size(), [](const T& value) { return radix_key<T>::get(value); });
+    }
+
+    /// stable sort by `key(value)`, e.g. events by timestamp. keys are sorted together with indices,
+    /// so every element is moved only once however large it is
+    template<typename T, typename P>
+    requires std::invocable<const P&, const T&> && radix_sortable<std::remove_cvref_t<std::invoke_result_t<const P&, const T&>>>
+    ORC_API auto radix_sort_by(const std::span<T> values, const P& key) -> void {
+        using K = std::remove_cvref_t<std::invoke_result_t<const P&, const T&>>;
+        using U = _radix_key_t<K>;
+        const usize n = values.size();
+        if (n < _RADIX_THRESHOLD) {
+            algorithms::stable_sort(values, [&key](const T& l, const T& r) {
+                return utils::cmp::cmp(radix_key<K>::get(key(l)), radix_key<K>::get(key(r)));
+            });
+            return;
+        }
+        std::vector<std::pair<U, usize>> order(n), scratch(n);
+        for (usize i = 0; i < n; ++i) order[i] = {radix_key<K>::get(key(values[i])), i};
+        _lsd_sort(order.data(), scratch.data(), n, [](const std::pair<U, usize>& item) { return item.first; });
+        if constexpr (std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T>) {
+            std::vector<T> sorted(n);
+            for (usize i = 0; i < n; ++i) sorted[i] = values[order[i].second];
+            std::copy(sorted.begin(), sorted.end(), values.begin());
+        } else {
+            std::vector<T> sorted;
+            sorted.reserve(n);
+            for (usize i = 0; i < n; ++i) sorted.push_back(std::move(values[order[i].second]));
+            std::move(sorted.begin(), sorted.end(), values.begin());
+        }
+    }
+
+    template<typename T, class Alloc>
+    ORC_API auto radix_sort(containers::vector<T, Alloc>& vec) -> void { algorithms::radix_sort(_as_span(vec)); }
+    template<typename T, class Alloc, typename P>
+    ORC_API auto radix_sort_by(containers::vector<T, Alloc>& vec, const P& key) -> void { algorithms::radix_sort_by(_as_span(vec), key); }
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <span>
+#include <type_traits>
+#include <orc_export.hpp>
+#include <ordefs.hpp>
+
+#include "compare.hpp"
+#include "optional.hpp"
+
+using namespace orc::core::defines;
+
+namespace orc::algorithms {
+
+    /// halves the range without branching on the comparison: `first` moves by a select, not a jump,
+    /// so the loop runs exactly log2(n) times and never mispredicts. returns the first index where `go_right` is false
+    template<typename T, typename F>
+    [[nodiscard]] constexpr auto _branchless_search(const std::span<const T> values, const F& go_right) -> usize {
+        usize n = values.size();
+        if (n == 0) return 0;
+        const T* first = values.data();
+        while (n > 1) {
+            const usize half = n / 2;
+            first = go_right(first[half]) ? first + half : first;
+            n -= half;
+        }
+        return static_cast<usize>(first - values.data()) + go_right(*first);
+    }
+
+    /// index of the first element not less than `value`, `values` must be sorted by `c`.
+    /// `c` compares an element with the value, so elements can be searched by a key
+    template<typename T, typename V, typename C = natural_order>
+    requires comparator<C, T, V>
+    [[nodiscard]] ORC_API constexpr auto lower_bound(const std::span<T> values, const V& value, const C& c = {}) -> usize {
+        const _less<C> less{c};
+        return _branchless_search<std::remove_const_t<T>>(values, [&](const T& elem) { return less(elem, value); });
+    }
+    /// index of the first element greater than `value`
+    template<typename T, typename V, typename C = natural_order>
+    requires comparator<C, T, V>
+    [[nodiscard]] ORC_API constexpr auto upper_bound(const std::span<T> values, const V& value, const C& c = {}) -> usize {
+        if constexpr (std::is_same_v<C, natural_order>) {
+            return _branchless_search<std::remove_const_t<T>>(values, [&](const T& elem) { return !(value < elem); });
+        } else {
+            return _branchless_search<std::remove_const_t<T>>(values, [&](const T& elem) { return c(elem, value) != utils::cmp::ordering::Greater; });
+        }
+    }
+    /// index of an element equal to `value`
+    template<typename T, typename V, typename C = natural_order>
+    requires comparator<C, T, V>
+    [[nodiscard]] ORC_API constexpr auto binary_search(const std::span<T> values, const V& value, const C& c = {}) -> optional::optional<usize> {
+        const usize idx = algorithms::lower_bound(values, value, c);
+        if (idx == values.size() || c(values[idx], value) != utils::cmp::ordering::Equal) return optional::none;
+        return optional::some(usize{idx});
+    }
+
+    template<typename T, class Alloc, typename... Args>
+    [[nodiscard]] ORC_API auto lower_bound(const containers::vector<T, Alloc>& vec, Args&&... args) -> usize {
+        return algorithms::lower_bound(_as_span(vec), std::forward<Args>(args)...);
+    }
+    template<typename T, class Alloc, typename... Args>
+    [[nodiscard]] ORC_API auto upper_bound(const containers::vector<T, Alloc>& vec, Args&&... args) -> usize {
+        return algorithms::upper_bound(_as_span(vec), std::forward<Args>(args)...);
+    }
+    template<typename T, class Alloc, typename... Args>
+    [[nodiscard]] ORC_API auto binary_search(const containers::vector<T, Alloc>& vec, Args&&... args) -> optional::optional<usize> {
+        return algorithms::binary_search(_as_span(vec), std::forward<Args>(args)...);
+    }
+}
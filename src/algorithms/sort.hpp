@@ -0,0 +1,509 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <exception>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <orc_export.hpp>
+#include <ordefs.hpp>
+
+#include "compare.hpp"
+
+using namespace orc::core::defines;
+
+namespace orc::algorithms {
+
+    inline constexpr usize _INSERTION_THRESHOLD = 24;
+    inline constexpr usize _NINTHER_THRESHOLD = 128;
+    inline constexpr usize _PARTIAL_INSERTION_LIMIT = 8;
+    inline constexpr usize _PARTITION_BLOCK = 64;
+    inline constexpr usize _MERGE_RUN = 32;
+    /// below this many elements per thread, spawning costs more than it saves
+    inline constexpr usize _PARALLEL_GRAIN = 1 << 14;
+
+    template<typename T, typename L>
+    constexpr auto _insertion_sort(T* first, T* last, const L& less) -> void {
+        if (first == last) return;
+        for (T* cur = first + 1; cur != last; ++cur) {
+            if (!less(*cur, *(cur - 1))) continue;
+            T tmp = std::move(*cur);
+            T* sift = cur;
+            do {
+                *sift = std::move(*(sift - 1));
+                --sift;
+            } while (sift != first && less(tmp, *(sift - 1)));
+            *sift = std::move(tmp);
+        }
+    }
+    /// `*(first - 1)` must not be greater than any element of the range
+    template<typename T, typename L>
+    constexpr auto _unguarded_insertion_sort(T* first, T* last, const L& less) -> void {
+        if (first == last) return;
+        for (T* cur = first + 1; cur != last; ++cur) {
+            if (!less(*cur, *(cur - 1))) continue;
+            T tmp = std::move(*cur);
+            T* sift = cur;
+            do {
+                *sift = std::move(*(sift - 1));
+                --sift;
+            } while (less(tmp, *(sift - 1)));
+            *sift = std::move(tmp);
+        }
+    }
+    /// insertion sort which gives up after a few moves, returns whether the range ended up sorted
+    template<typename T, typename L>
+    constexpr auto _partial_insertion_sort(T* first, T* last, const L& less) -> bool {
+        if (first == last) return true;
+        usize moved = 0;
+        for (T* cur = first + 1; cur != last; ++cur) {
+            if (!less(*cur, *(cur - 1))) continue;
+            T tmp = std::move(*cur);
+            T* sift = cur;
+            do {
+                *sift = std::move(*(sift - 1));
+                --sift;
+            } while (sift != first && less(tmp, *(sift - 1)));
+            *sift = std::move(tmp);
+            moved += static_cast<usize>(cur - sift);
+            if (moved > _PARTIAL_INSERTION_LIMIT) return false;
+        }
+        return true;
+    }
+
+    template<typename T, typename L>
+    constexpr auto _sort2(T* a, T* b, const L& less) -> void {
+        if (less(*b, *a)) std::swap(*a, *b);
+    }
+    template<typename T, typename L>
+    constexpr auto _sort3(T* a, T* b, T* c, const L& less) -> void {
+        _sort2(a, b, less);
+        _sort2(b, c, less);
+        _sort2(a, b, less);
+    }
+    /// moves the median of three or of a ninther to `*first`, leaving an element not less than it at `last - 1`
+    template<typename T, typename L>
+    constexpr auto _choose_pivot(T* first, T* last, const L& less) -> void {
+        const usize size = static_cast<usize>(last - first);
+        const usize half = size / 2;
+        if (size > _NINTHER_THRESHOLD) {
+            _sort3(first, first + half, last - 1, less);
+            _sort3(first + 1, first + (half - 1), last - 2, less);
+            _sort3(first + 2, first + (half + 1), last - 3, less);
+            _sort3(first + (half - 1), first + half, first + (half + 1), less);
+            std::swap(*first, *(first + half));
+        } else {
+            _sort3(first + half, first, last - 1, less);
+        }
+    }
+
+    /// partitions around `*first` into `< pivot` and `>= pivot`, returns the pivot position and whether nothing had to move
+    template<typename T, typename L>
+    auto _partition_right(T* const first, T* const last, const L& less) -> std::pair<T*, bool> {
+        T pivot = std::move(*first);
+        T* lo = first;
+        T* hi = last;
+        // the pivot is a median, so both scans are guarded by an element on the other side
+        while (less(*++lo, pivot));
+        if (lo - 1 == first) while (lo < hi && !less(*--hi, pivot));
+        else while (!less(*--hi, pivot));
+        const bool already_partitioned = lo >= hi;
+        while (lo < hi) {
+            std::swap(*lo, *hi);
+            while (less(*++lo, pivot));
+            while (!less(*--hi, pivot));
+        }
+        T* const pivot_pos = lo - 1;
+        *first = std::move(*pivot_pos);
+        *pivot_pos = std::move(pivot);
+        return {pivot_pos, already_partitioned};
+    }
+
+    template<typename T>
+    auto _swap_offsets(T* const left, T* const right, const u8* offsets_l, const u8* offsets_r, const usize count, const bool use_swaps) -> void {
+        if (use_swaps) {
+            // equal counts mean both blocks are exhausted, plain swaps keep the cycle below from overlapping
+            for (usize i = 0; i < count; ++i) std::swap(*(left + offsets_l[i]), *(right - offsets_r[i]));
+        } else if (count > 0) {
+            T* l = left + offsets_l[0];
+            T* r = right - offsets_r[0];
+            T tmp = std::move(*l);
+            *l = std::move(*r);
+            for (usize i = 1; i < count; ++i) {
+                l = left + offsets_l[i];
+                *r = std::move(*l);
+                r = right - offsets_r[i];
+                *l = std::move(*r);
+            }
+            *r = std::move(tmp);
+        }
+    }
+    /// `_partition_right` without data-dependent branches: misplaced elements are first collected into offset blocks
+    /// by adding comparison results, then swapped in bulk (BlockQuicksort)
+    template<typename T, typename L>
+    auto _partition_right_branchless(T* const first, T* const last, const L& less) -> std::pair<T*, bool> {
+        T pivot = std::move(*first);
+        T* lo = first;
+        T* hi = last;
+        while (less(*++lo, pivot));
+        if (lo - 1 == first) while (lo < hi && !less(*--hi, pivot));
+        else while (!less(*--hi, pivot));
+        const bool already_partitioned = lo >= hi;
+        if (!already_partitioned) {
+            std::swap(*lo, *hi);
+            ++lo;
+
+            alignas(64) u8 offsets_l[_PARTITION_BLOCK];
+            alignas(64) u8 offsets_r[_PARTITION_BLOCK];
+            T* base_l = lo;
+            T* base_r = hi;
+            usize num_l = 0, num_r = 0, start_l = 0, start_r = 0;
+            while (lo < hi) {
+                const usize unknown = static_cast<usize>(hi - lo);
+                const usize left_split = num_l == 0 ? (num_r == 0 ? unknown / 2 : unknown) : 0;
+                const usize right_split = num_r == 0 ? unknown - left_split : 0;
+
+                const usize count_l = std::min<usize>(left_split, _PARTITION_BLOCK);
+                for (usize i = 0; i < count_l; ++i) {
+                    offsets_l[num_l] = static_cast<u8>(i);
+                    num_l += !less(*lo, pivot);
+                    ++lo;
+                }
+                const usize count_r = std::min<usize>(right_split, _PARTITION_BLOCK);
+                for (usize i = 0; i < count_r;) {
+                    offsets_r[num_r] = static_cast<u8>(++i);
+                    num_r += less(*--hi, pivot);
+                }
+
+                const usize count = std::min<usize>(num_l, num_r);
+                _swap_offsets(base_l, base_r, offsets_l + start_l, offsets_r + start_r, count, num_l == num_r);
+                num_l -= count;
+                num_r -= count;
+                start_l += count;
+                start_r += count;
+                if (num_l == 0) {
+                    start_l = 0;
+                    base_l = lo;
+                }
+                if (num_r == 0) {
+                    start_r = 0;
+                    base_r = hi;
+                }
+            }
+            // at most one block still holds misplaced elements, move them next to the boundary
+            if (num_l != 0) {
+                while (num_l-- != 0) std::swap(*(base_l + offsets_l[start_l + num_l]), *--hi);
+                lo = hi;
+            }
+            if (num_r != 0) {
+                while (num_r-- != 0) std::swap(*(base_r - offsets_r[start_r + num_r]), *lo++);
+                hi = lo;
+            }
+        }
+        T* const pivot_pos = lo - 1;
+        *first = std::move(*pivot_pos);
+        *pivot_pos = std::move(pivot);
+        return {pivot_pos, already_partitioned};
+    }
+
+    /// partitions around `*first` into `<= pivot` and `> pivot`, used when the pivot equals the previous one
+    template<typename T, typename L>
+    auto _partition_left(T* const first, T* const last, const L& less) -> T* {
+        T pivot = std::move(*first);
+        T* lo = first;
+        T* hi = last;
+        while (less(pivot, *--hi));
+        if (hi + 1 == last) while (lo < hi && !less(pivot, *++lo));
+        else while (!less(pivot, *++lo));
+        while (lo < hi) {
+            std::swap(*lo, *hi);
+            while (less(pivot, *--hi));
+            while (!less(pivot, *++lo));
+        }
+        *first = std::move(*hi);
+        *hi = std::move(pivot);
+        return hi;
+    }
+
+    template<typename T, typename L>
+    auto _heap_sort(T* first, T* last, const L& less) -> void {
+        std::make_heap(first, last, less);
+        std::sort_heap(first, last, less);
+    }
+
+    /// swaps a few elements of both sides so that adversarial inputs stop producing the same bad pivots
+    template<typename T>
+    auto _break_patterns(T* first, T* pivot_pos, T* last) -> void {
+        const usize l_size = static_cast<usize>(pivot_pos - first);
+        const usize r_size = static_cast<usize>(last - (pivot_pos + 1));
+        if (l_size >= _INSERTION_THRESHOLD) {
+            std::swap(*first, *(first + l_size / 4));
+            std::swap(*(pivot_pos - 1), *(pivot_pos - l_size / 4));
+            if (l_size > _NINTHER_THRESHOLD) {
+                std::swap(*(first + 1), *(first + (l_size / 4 + 1)));
+                std::swap(*(first + 2), *(first + (l_size / 4 + 2)));
+                std::swap(*(pivot_pos - 2), *(pivot_pos - (l_size / 4 + 1)));
+                std::swap(*(pivot_pos - 3), *(pivot_pos - (l_size / 4 + 2)));
+            }
+        }
+        if (r_size >= _INSERTION_THRESHOLD) {
+            std::swap(*(pivot_pos + 1), *(pivot_pos + (1 + r_size / 4)));
+            std::swap(*(last - 1), *(last - r_size / 4));
+            if (r_size > _NINTHER_THRESHOLD) {
+                std::swap(*(pivot_pos + 2), *(pivot_pos + (2 + r_size / 4)));
+                std::swap(*(pivot_pos + 3), *(pivot_pos + (3 + r_size / 4)));
+                std::swap(*(last - 2), *(last - (1 + r_size / 4)));
+                std::swap(*(last - 3), *(last - (2 + r_size / 4)));
+            }
+        }
+    }
+
+    /// pattern-defeating quicksort: introsort with equal-key detection, sorted-run detection and a heap sort fallback
+    template<bool Branchless, typename T, typename L>
+    auto _pdqsort(T* first, T* last, const L& less, i32 bad_allowed, bool leftmost) -> void {
+        for (;;) {
+            const usize size = static_cast<usize>(last - first);
+            if (size < _INSERTION_THRESHOLD) {
+                if (leftmost) _insertion_sort(first, last, less);
+                else _unguarded_insertion_sort(first, last, less);
+                return;
+            }
+            _choose_pivot(first, last, less);
+            // nothing in the range is less than the element before it, equal pivots mean a run of equal keys
+            if (!leftmost && !less(*(first - 1), *first)) {
+                first = _partition_left(first, last, less) + 1;
+                continue;
+            }
+            const auto [pivot_pos, already_partitioned] = Branchless
+                ? _partition_right_branchless(first, last, less)
+                : _partition_right(first, last, less);
+
+            const usize l_size = static_cast<usize>(pivot_pos - first);
+            const usize r_size = static_cast<usize>(last - (pivot_pos + 1));
+            if (l_size < size / 8 || r_size < size / 8) {
+                if (--bad_allowed == 0) {
+                    _heap_sort(first, last, less);
+                    return;
+                }
+                _break_patterns(first, pivot_pos, last);
+            } else if (already_partitioned && _partial_insertion_sort(first, pivot_pos, less) &&
+                       _partial_insertion_sort(pivot_pos + 1, last, less)) {
+                return;
+            }
+            _pdqsort<Branchless>(first, pivot_pos, less, bad_allowed, leftmost);
+            first = pivot_pos + 1;
+            leftmost = false;
+        }
+    }
+
+    /// unstable in-place sort, O(n log n) worst case
+    template<typename T, comparator<T> C = natural_order>
+    ORC_API auto sort(const std::span<T> values, const C& c = {}) -> void {
+        if (values.size() < 2) return;
+        const _less<C> less{c};
+        _pdqsort<_branchless<T, C>>(values.data(), values.data() + values.size(), less, std::bit_width(values.size()), true);
+    }
+
+    /// uninitialized storage for `n` elements
+    template<typename T>
+    struct _buffer {
+        explicit _buffer(const usize n) : data(std::allocator<T>().allocate(n)), cap(n) {}
+        _buffer(const _buffer&) = delete;
+        auto operator=(const _buffer&) -> _buffer& = delete;
+        ~_buffer() { std::allocator<T>().deallocate(data, cap); }
+        T* data;
+        usize cap;
+    };
+
+    /// stable merge of the sorted runs `[first, mid)` and `[mid, last)`, the left run is moved into `buffer` first
+    template<typename T, typename L>
+    auto _merge(T* first, T* mid, T* last, T* buffer, const L& less) -> void {
+        if (first == mid || mid == last || !less(*mid, *(mid - 1))) return;
+        T* const buffer_end = std::uninitialized_move(first, mid, buffer);
+        T* a = buffer;
+        T* b = mid;
+        T* out = first;
+        try {
+            while (a != buffer_end && b != last) {
+                if (less(*b, *a)) *out++ = std::move(*b++);
+                else *out++ = std::move(*a++);
+            }
+        } catch (...) {
+            // the gap [out, b) has exactly the size of the unmerged buffer, refill it before unwinding
+            std::move(a, buffer_end, out);
+            std::destroy(buffer, buffer_end);
+            throw;
+        }
+        std::move(a, buffer_end, out);
+        std::destroy(buffer, buffer_end);
+    }
+    template<typename T, typename L>
+    auto _merge_sort(T* first, T* last, T* buffer, const L& less) -> void {
+        const usize size = static_cast<usize>(last - first);
+        if (size <= _MERGE_RUN) {
+            _insertion_sort(first, last, less);
+            return;
+        }
+        T* const mid = first + size / 2;
+        _merge_sort(first, mid, buffer, less);
+        _merge_sort(mid, last, buffer, less);
+        _merge(first, mid, last, buffer, less);
+    }
+
+    /// stable sort, keeps the relative order of equal elements. allocates `n / 2` elements of scratch space
+    template<typename T, comparator<T> C = natural_order>
+    ORC_API auto stable_sort(const std::span<T> values, const C& c = {}) -> void {
+        if (values.size() < 2) return;
+        const _less<C> less{c};
+        T* const first = values.data();
+        T* const last = first + values.size();
+        if (values.size() <= _MERGE_RUN) {
+            _insertion_sort(first, last, less);
+            return;
+        }
+        _buffer<T> buffer(values.size() / 2 + 1);
+        _merge_sort(first, last, buffer.data, less);
+    }
+
+    /// reorders `values` so that `values[n]` is the element a full sort would put there,
+    /// with no greater element before it and no smaller one after it
+    template<typename T, comparator<T> C = natural_order>
+    ORC_API auto nth_element(const std::span<T> values, const usize n, const C& c = {}) -> void {
+        if (n >= values.size()) throw std::out_of_range("index out of range");
+        const _less<C> less{c};
+        T* first = values.data();
+        T* last = first + values.size();
+        T* const nth = first + n;
+        i32 bad_allowed = std::bit_width(values.size());
+        bool leftmost = true;
+        while (static_cast<usize>(last - first) >= _INSERTION_THRESHOLD) {
+            _choose_pivot(first, last, less);
+            if (!leftmost && !less(*(first - 1), *first)) {
+                // [first, pivot] only holds keys equal to the previous pivot
+                T* const pivot_pos = _partition_left(first, last, less);
+                if (nth <= pivot_pos) return;
+                first = pivot_pos + 1;
+                continue;
+            }
+            const usize size = static_cast<usize>(last - first);
+            const auto [pivot_pos, already_partitioned] = _branchless<T, C>
+                ? _partition_right_branchless(first, last, less)
+                : _partition_right(first, last, less);
+            (void)already_partitioned;
+            if (pivot_pos == nth) return;
+            const usize l_size = static_cast<usize>(pivot_pos - first);
+            const usize r_size = static_cast<usize>(last - (pivot_pos + 1));
+            if (l_size < size / 8 || r_size < size / 8) {
+                if (--bad_allowed == 0) {
+                    _heap_sort(first, last, less);
+                    return;
+                }
+                _break_patterns(first, pivot_pos, last);
+            }
+            if (nth < pivot_pos) {
+                last = pivot_pos;
+            } else {
+                first = pivot_pos + 1;
+                leftmost = false;
+            }
+        }
+        if (leftmost) _insertion_sort(first, last, less);
+        else _unguarded_insertion_sort(first, last, less);
+    }
+
+    /// moves the elements satisfying `pred` to the front, returns how many there are. not stable
+    template<typename T, typename P>
+    requires std::predicate<const P&, const T&>
+    ORC_API auto partition(const std::span<T> values, const P& pred) -> usize {
+        T* const begin = values.data();
+        T* first = begin;
+        T* last = begin + values.size();
+        for (;;) {
+            for (;; ++first) {
+                if (first == last) return static_cast<usize>(first - begin);
+                if (!pred(*first)) break;
+            }
+            do {
+                if (--last == first) return static_cast<usize>(first - begin);
+            } while (!pred(*last));
+            std::swap(*first, *last);
+            ++first;
+        }
+    }
+
+    /// sorts chunks on separate threads and merges them pairwise, also in parallel.
+    /// `threads == 0` uses every hardware thread, small inputs are sorted on the calling thread
+    template<bool Stable, typename T, typename C>
+    auto _parallel_sort(const std::span<T> values, const C& c, usize threads) -> void {
+        if (threads == 0) threads = std::max<usize>(1, std::thread::hardware_concurrency());
+        const usize chunks = std::min<usize>(threads, values.size() / _PARALLEL_GRAIN);
+        const auto sort_one = [&c](const std::span<T> part) {
+            if constexpr (Stable) algorithms::stable_sort(part, c);
+            else algorithms::sort(part, c);
+        };
+        if (chunks < 2) {
+            sort_one(values);
+            return;
+        }
+        std::vector<usize> bounds(chunks + 1);
+        for (usize i = 0; i <= chunks; ++i) bounds[i] = values.size() * i / chunks;
+
+        std::vector<std::exception_ptr> errors(chunks);
+        const auto run = [&errors](const usize tasks, auto&& task) {
+            std::vector<std::thread> workers;
+            workers.reserve(tasks - 1);
+            for (usize i = 1; i < tasks; ++i)
+                workers.emplace_back([&errors, &task, i] {
+                    try { task(i); } catch (...) { errors[i] = std::current_exception(); }
+                });
+            try { task(0); } catch (...) { errors[0] = std::current_exception(); }
+            for (auto& worker : workers) worker.join();
+            for (usize i = 0; i < tasks; ++i)
+                if (errors[i]) std::rethrow_exception(errors[i]);
+        };
+
+        T* const data = values.data();
+        run(chunks, [&](const usize i) { sort_one(values.subspan(bounds[i], bounds[i + 1] - bounds[i])); });
+        const _less<C> less{c};
+        _buffer<T> buffer(values.size());
+        for (usize width = 1; width < chunks; width *= 2) {
+            const usize pairs = (chunks + 2 * width - 1) / (2 * width);
+            run(pairs, [&](const usize i) {
+                const usize lo = bounds[2 * width * i];
+                const usize mid = bounds[std::min<usize>(2 * width * i + width, chunks)];
+                const usize hi = bounds[std::min<usize>(2 * width * (i + 1), chunks)];
+                // every pair owns the buffer slice under its own range
+                _merge(data + lo, data + mid, data + hi, buffer.data + lo, less);
+            });
+        }
+    }
+
+    /// `sort` spread over `threads` threads
+    template<typename T, comparator<T> C = natural_order>
+    ORC_API auto parallel_sort(const std::span<T> values, const C& c = {}, const usize threads = 0) -> void {
+        _parallel_sort<false>(values, c, threads);
+    }
+    /// `stable_sort` spread over `threads` threads
+    template<typename T, comparator<T> C = natural_order>
+    ORC_API auto parallel_stable_sort(const std::span<T> values, const C& c = {}, const usize threads = 0) -> void {
+        _parallel_sort<true>(values, c, threads);
+    }
+
+    template<typename T, class Alloc, typename... Args>
+    ORC_API auto sort(containers::vector<T, Alloc>& vec, Args&&... args) -> void { algorithms::sort(_as_span(vec), std::forward<Args>(args)...); }
+    template<typename T, class Alloc, typename... Args>
+    ORC_API auto stable_sort(containers::vector<T, Alloc>& vec, Args&&... args) -> void { algorithms::stable_sort(_as_span(vec), std::forward<Args>(args)...); }
+    template<typename T, class Alloc, typename... Args>
+    ORC_API auto nth_element(containers::vector<T, Alloc>& vec, Args&&... args) -> void { algorithms::nth_element(_as_span(vec), std::forward<Args>(args)...); }
+    template<typename T, class Alloc, typename... Args>
+    ORC_API auto partition(containers::vector<T, Alloc>& vec, Args&&... args) -> usize { return algorithms::partition(_as_span(vec), std::forward<Args>(args)...); }
+    template<typename T, class Alloc, typename... Args>
+    ORC_API auto parallel_sort(containers::vector<T, Alloc>& vec, Args&&... args) -> void { algorithms::parallel_sort(_as_span(vec), std::forward<Args>(args)...); }
+    template<typename T, class Alloc, typename... Args>
+    ORC_API auto parallel_stable_sort(containers::vector<T, Alloc>& vec, Args&&... args) -> void {
+        algorithms::parallel_stable_sort(_as_span(vec), std::forward<Args>(args)...);
+    }
+}
@@ -1,24 +1,50 @@
 #pragma once
+#include <concepts>
 #include <stdexcept>
+#include <string>
+#include <string_view>
 #include <orc_export.hpp>
+#include <ordefs.hpp>
+#include <checks.hpp>
+
+/// assertions which are compiled out below `ORC_CHECKS` level 2. the condition stays type-checked
+/// but is not evaluated, the message is only built once the check fails
+#if ORC_CHECKS >= 2
+#define ORC_ASSERT(cond) \
+    do { if (!(cond)) [[unlikely]] ::orc::assert::_fail("assertion failed: " #cond); } while (false)
+#define ORC_ASSERT_MSG(cond, msg) \
+    do { if (!(cond)) [[unlikely]] ::orc::assert::_fail(msg); } while (false)
+#define ORC_ASSERT_EQ(left, right) \
+    do { if (!((left) == (right))) [[unlikely]] ::orc::assert::_fail("assertion failed: " #left " == " #right); } while (false)
+#else
+#define ORC_ASSERT(cond) ((void)sizeof(!(cond)))
+#define ORC_ASSERT_MSG(cond, msg) ((void)sizeof(!(cond)))
+#define ORC_ASSERT_EQ(left, right) ((void)sizeof((left) == (right)))
+#endif
+
 namespace orc::assert {
+    [[noreturn]] ORC_COLD ORC_API inline auto _fail(const std::string_view msg) -> void {
+        throw std::runtime_error(std::string(msg));
+    }
+
+    /// always checked, use `ORC_ASSERT` for checks that should vanish from release builds
     ORC_API inline auto assert(const bool cond) {
-        if (!cond) throw std::runtime_error("assertion failed");
+        if (!cond) [[unlikely]] _fail("assertion failed");
     }
 
     template<typename T, typename E>
     requires std::equality_comparable_with<T, E>
     ORC_API auto assert_eq(T&& left, E&& right) {
-        if (left != right) throw std::runtime_error("assertation failed! left expression != right expression");
+        if (left != right) [[unlikely]] _fail("assertation failed! left expression != right expression");
     }
 
-    ORC_API inline auto assert(const bool cond, const std::string& msg) {
-        if (!cond) throw std::runtime_error(msg);
+    ORC_API inline auto assert(const bool cond, const std::string_view msg) {
+        if (!cond) [[unlikely]] _fail(msg);
     }
 
     template<typename T, typename E>
     requires std::equality_comparable_with<T, E>
-    ORC_API auto assert_eq(T&& left, E&& right, const std::string& msg) {
-        if (left != right) throw std::runtime_error(msg);
+    ORC_API auto assert_eq(T&& left, E&& right, const std::string_view msg) {
+        if (left != right) [[unlikely]] _fail(msg);
     }
 }
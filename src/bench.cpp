@@ -0,0 +1,265 @@
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+#include "arithmetic.hpp"
+#include "format.hpp"
+#include "persistent_vector.hpp"
+#include "redtime.hpp"
+#include "rope.hpp"
+#include "rstring.hpp"
+#include "sort.hpp"
+#include "vector.hpp"
+
+using namespace orc;
+using bench::do_not_optimize;
+
+namespace {
+    constexpr usize N = 1 << 16;
+
+    auto bench_vector(bench::suite& s) -> void {
+        s.run("vector/push", "orc", N, [] {
+            containers::vector<i32> v;
+            for (usize i = 0; i < N; ++i) v.push(static_cast<i32>(i));
+            do_not_optimize(v.start());
+        });
+        s.run("vector/push", "std", N, [] {
+            std::vector<i32> v;
+            for (usize i = 0; i < N; ++i) v.push_back(static_cast<i32>(i));
+            do_not_optimize(v.data());
+        });
+        s.run("vector/push", "orc persistent", N, [] {
+            containers::persistent_vector<i32> v;
+            for (usize i = 0; i < N; ++i) v = v.push(static_cast<i32>(i));
+            do_not_optimize(v.size());
+        });
+        s.run("vector/push", "orc transient", N, [] {
+            auto v = containers::persistent_vector<i32>().transient();
+            for (usize i = 0; i < N; ++i) v.push(static_cast<i32>(i));
+            do_not_optimize(v.persistent().size());
+        });
+
+        containers::vector<i32> orc_src(N);
+        std::vector<i32> std_src;
+        for (usize i = 0; i < N; ++i) {
+            orc_src.push(static_cast<i32>(i));
+            std_src.push_back(static_cast<i32>(i));
+        }
+        s.run("vector/copy", "orc", N, [&] {
+            const containers::vector<i32> copy(orc_src);
+            do_not_optimize(copy.start());
+        });
+        s.run("vector/copy", "std", N, [&] {
+            const std::vector<i32> copy(std_src);
+            do_not_optimize(copy.data());
+        });
+        // a snapshot shares the whole trie
+        const auto persistent_src = containers::persistent_vector<i32>::from_iter(containers::vector_iterator<i32>(orc_src).clone());
+        s.run("vector/copy", "orc persistent", N, [&] {
+            const containers::persistent_vector<i32> copy(persistent_src);
+            do_not_optimize(copy.size());
+        });
+
+        // growth of elements that are expensive to relocate
+        s.run("vector/growth", "orc", N / 16, [] {
+            containers::vector<std::string> v;
+            for (usize i = 0; i < N / 16; ++i) v.push(std::string(32, 'x'));
+            do_not_optimize(v.start());
+        });
+        s.run("vector/growth", "std", N / 16, [] {
+            std::vector<std::string> v;
+            for (usize i = 0; i < N / 16; ++i) v.push_back(std::string(32, 'x'));
+            do_not_optimize(v.data());
+        });
+    }
+
+    auto bench_iterators(bench::suite& s) -> void {
+        containers::vector<i32> orc_src(N);
+        std::vector<i32> std_src(N);
+        for (usize i = 0; i < N; ++i) {
+            orc_src.push(static_cast<i32>(i));
+            std_src[i] = static_cast<i32>(i);
+        }
+        s.run("iterator/map_collect", "orc", N, [&] {
+            auto out = containers::vector_iterator<i32>(orc_src)
+                .map<i32>([](const i32 x) { return x * 3; })
+                ->map<i32>([](const i32 x) { return x + 1; })
+                ->collect<containers::vector<i32>>();
+            do_not_optimize(out.start());
+        });
+        s.run("iterator/map_collect", "std", N, [&] {
+            std::vector<i32> out;
+            std::transform(std_src.begin(), std_src.end(), std::back_inserter(out), [](const i32 x) { return x * 3 + 1; });
+            do_not_optimize(out.data());
+        });
+    }
+
+    auto bench_strings(bench::suite& s) -> void {
+        constexpr usize COUNT = 1024;
+        const char* text = "the quick brown fox jumps over the lazy dog, again and again and again";
+        const usize text_len = std::char_traits<char>::length(text);
+        s.run("string/construct", "orc", COUNT * text_len, [&] {
+            for (usize i = 0; i < COUNT; ++i) {
+                strings::mutable_u8string<> str(text);
+                do_not_optimize(str.size());
+            }
+        });
+        s.run("string/construct", "std", COUNT * text_len, [&] {
+            for (usize i = 0; i < COUNT; ++i) {
+                std::string str(text);
+                do_not_optimize(str.data());
+            }
+        });
+
+        s.run("string/build", "orc builder", COUNT * text_len, [&] {
+            strings::string_builder builder;
+            for (usize i = 0; i < COUNT; ++i) builder.append(std::string_view(text, text_len));
+            do_not_optimize(builder.take_string().data());
+        });
+        s.run("string/build", "orc to u8string", COUNT * text_len, [&] {
+            strings::string_builder builder;
+            for (usize i = 0; i < COUNT; ++i) builder.append(std::string_view(text, text_len));
+            do_not_optimize(builder.build().size());
+        });
+        s.run("string/build", "std", COUNT * text_len, [&] {
+            std::string str;
+            for (usize i = 0; i < COUNT; ++i) str += text;
+            do_not_optimize(str.data());
+        });
+
+        const strings::mutable_u8string<> orc_str(text);
+        const std::string std_str(text);
+        s.run("string/print", "orc", COUNT * text_len, [&] {
+            std::ostringstream os;
+            for (usize i = 0; i < COUNT; ++i) os << orc_str;
+            do_not_optimize(os);
+        });
+        s.run("string/print", "orc format_to", COUNT * text_len, [&] {
+            format::string_sink out;
+            for (usize i = 0; i < COUNT; ++i) out << orc_str;
+            do_not_optimize(out.str().data());
+        });
+        s.run("string/print", "std", COUNT * text_len, [&] {
+            std::ostringstream os;
+            for (usize i = 0; i < COUNT; ++i) os << std_str;
+            do_not_optimize(os);
+        });
+    }
+
+    auto bench_time(bench::suite& s) -> void {
+        constexpr usize COUNT = 4096;
+        s.run("time/from_exact_date", "orc", COUNT, [] {
+            i64 sum = 0;
+            for (usize i = 0; i < COUNT; ++i) {
+                const auto t = time::time::from_exact_date(1970 + static_cast<i32>(i % 100), static_cast<u8>(1 + i % 12),
+                                                           static_cast<u8>(1 + i % 28), 12, 30, 15);
+                sum += t.get_ok().raw_value();
+            }
+            do_not_optimize(sum);
+        });
+        s.run("time/from_exact_date", "std", COUNT, [] {
+            using namespace std::chrono;
+            i64 sum = 0;
+            for (usize i = 0; i < COUNT; ++i) {
+                const year_month_day date{year{1970 + static_cast<i32>(i % 100)}, month{static_cast<u32>(1 + i % 12)},
+                                          day{static_cast<u32>(1 + i % 28)}};
+                if (!date.ok()) continue;
+                sum += (sys_days{date}.time_since_epoch() + hours{12} + minutes{30} + seconds{15}) / seconds{1};
+            }
+            do_not_optimize(sum);
+        });
+
+        s.run("time/format", "orc", COUNT, [] {
+            format::string_sink out;
+            for (usize i = 0; i < COUNT; ++i) out << time::time(static_cast<i64>(i) * 86'413);
+            do_not_optimize(out.str().data());
+        });
+        s.run("time/format", "std", COUNT, [] {
+            std::string out;
+            char buf[32];
+            for (usize i = 0; i < COUNT; ++i) {
+                const std::time_t t = static_cast<std::time_t>(i) * 86'413;
+                out.append(buf, std::strftime(buf, sizeof(buf), "%b %d %Y %H:%M:%S", std::gmtime(&t)));
+            }
+            do_not_optimize(out.data());
+        });
+    }
+
+    auto bench_arithmetic(bench::suite& s) -> void {
+        std::vector<i64> left(N), right(N), out(N);
+        for (usize i = 0; i < N; ++i) {
+            left[i] = static_cast<i64>(i * 7919 % 100'003) - 50'000;
+            right[i] = static_cast<i64>(i * 104'729 % 99'991) - 50'000;
+        }
+        s.run("arithmetic/checked_mul", "orc", N, [&] {
+            for (usize i = 0; i < N; ++i) out[i] = utils::arithmetic::checked_mul(left[i], right[i]).value_or(0);
+            do_not_optimize(out.data());
+        });
+        s.run("arithmetic/checked_mul", "orc span", N, [&] {
+            do_not_optimize(utils::arithmetic::checked_mul<i64>(left, right, out));
+        });
+        // the standard library has no checked or saturating arithmetic, plain operators are the baseline
+        s.run("arithmetic/checked_mul", "std", N, [&] {
+            for (usize i = 0; i < N; ++i) out[i] = left[i] * right[i];
+            do_not_optimize(out.data());
+        });
+
+        s.run("arithmetic/saturating_add", "orc", N, [&] {
+            for (usize i = 0; i < N; ++i) out[i] = utils::arithmetic::saturating_add(left[i], right[i]);
+            do_not_optimize(out.data());
+        });
+        s.run("arithmetic/saturating_add", "std", N, [&] {
+            for (usize i = 0; i < N; ++i) out[i] = left[i] + right[i];
+            do_not_optimize(out.data());
+        });
+
+        s.run("arithmetic/div_euclid", "orc", N, [&] {
+            for (usize i = 0; i < N; ++i) out[i] = utils::arithmetic::div_euclid(left[i], right[i] | 1);
+            do_not_optimize(out.data());
+        });
+        s.run("arithmetic/div_euclid", "std", N, [&] {
+            for (usize i = 0; i < N; ++i) out[i] = left[i] / (right[i] | 1);
+            do_not_optimize(out.data());
+        });
+    }
+
+    auto bench_sort(bench::suite& s) -> void {
+        std::vector<i64> input(N);
+        u64 state = 0x9E3779B97F4A7C15ull;
+        for (auto& v : input) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            v = static_cast<i64>(state);
+        }
+        std::vector<i64> work(N);
+        s.run("algorithms/sort", "orc", N, [&] {
+            work = input;
+            algorithms::sort(std::span(work));
+            do_not_optimize(work.data());
+        });
+        s.run("algorithms/sort", "std", N, [&] {
+            work = input;
+            std::sort(work.begin(), work.end());
+            do_not_optimize(work.data());
+        });
+    }
+}
+
+auto main(const int argc, char** argv) -> int {
+    bench::suite s(bench::parse_options(argc, argv));
+    bench_vector(s);
+    bench_iterators(s);
+    bench_strings(s);
+    bench_time(s);
+    bench_arithmetic(s);
+    bench_sort(s);
+    s.report(std::cout);
+    return 0;
+}
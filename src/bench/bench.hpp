@@ -0,0 +1,196 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <orc_export.hpp>
+#include <ordefs.hpp>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "format.hpp"
+
+using namespace orc::core::defines;
+
+namespace orc::bench {
+
+    /// keeps `value` alive so the computation producing it can not be optimized away
+    template<typename T>
+    auto do_not_optimize(const T& value) -> void {
+#if defined(_MSC_VER) && !defined(__clang__)
+        static volatile const void* sink;
+        sink = &value;
+        _ReadWriteBarrier();
+#else
+        asm volatile("" : : "r,m"(value) : "memory");
+#endif
+    }
+    /// forces pending stores to memory
+    inline auto clobber_memory() -> void {
+#if defined(_MSC_VER) && !defined(__clang__)
+        _ReadWriteBarrier();
+#else
+        asm volatile("" : : : "memory");
+#endif
+    }
+
+    /// reference cycles from the time stamp counter, 0 where there is none
+    [[nodiscard]] inline auto _ticks() noexcept -> u64 {
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return 0;
+#endif
+    }
+
+    struct ORC_API options {
+        usize warmup = 3;
+        usize runs = 31;
+        /// only benchmarks whose `group/name` contains it are run
+        std::string filter;
+        /// JSON report destination, empty for none
+        std::string json;
+    };
+
+    /// `--runs N --warmup N --filter TEXT --json PATH`
+    [[nodiscard]] inline auto parse_options(const int argc, char** argv) -> options {
+        options opts;
+        for (int i = 1; i + 1 < argc; i += 2) {
+            const std::string_view flag = argv[i];
+            if (flag == "--runs") opts.runs = std::max<usize>(1, std::strtoull(argv[i + 1], nullptr, 10));
+            else if (flag == "--warmup") opts.warmup = std::strtoull(argv[i + 1], nullptr, 10);
+            else if (flag == "--filter") opts.filter = argv[i + 1];
+            else if (flag == "--json") opts.json = argv[i + 1];
+        }
+        return opts;
+    }
+
+    /// per-element statistics of one benchmark, nanoseconds are per element
+    struct ORC_API result {
+        std::string group;
+        std::string name;
+        usize elements;
+        usize runs;
+        double min_ns;
+        double mean_ns;
+        double p50_ns;
+        double p90_ns;
+        double p99_ns;
+        /// median reference cycles per element, 0 without a cycle counter
+        double cycles;
+    };
+
+    class ORC_API suite {
+    public:
+        explicit suite(options opts) : opts(std::move(opts)) {}
+
+        /// times `body`, which must process `elements` elements per call, `warmup + runs` times
+        template<typename F>
+        auto run(const std::string_view group, const std::string_view name, const usize elements, F&& body) -> void {
+            std::string id(group);
+            id += '/';
+            id += name;
+            if (!opts.filter.empty() && id.find(opts.filter) == std::string::npos) return;
+            for (usize i = 0; i < opts.warmup; ++i) body();
+
+            std::vector<double> ns(opts.runs);
+            std::vector<u64> ticks(opts.runs);
+            for (usize i = 0; i < opts.runs; ++i) {
+                clobber_memory();
+                const u64 t0 = _ticks();
+                const auto start = std::chrono::steady_clock::now();
+                body();
+                const auto stop = std::chrono::steady_clock::now();
+                ticks[i] = _ticks() - t0;
+                clobber_memory();
+                ns[i] = std::chrono::duration<double, std::nano>(stop - start).count();
+            }
+            std::sort(ns.begin(), ns.end());
+            std::sort(ticks.begin(), ticks.end());
+            const double per = static_cast<double>(std::max<usize>(elements, 1));
+            double sum = 0;
+            for (const double v : ns) sum += v;
+            results.push_back(result{
+                std::string(group), std::string(name), elements, opts.runs,
+                ns.front() / per, sum / static_cast<double>(ns.size()) / per,
+                percentile(ns, 50) / per, percentile(ns, 90) / per, percentile(ns, 99) / per,
+                static_cast<double>(ticks[ticks.size() / 2]) / per,
+            });
+        }
+
+        [[nodiscard]] auto get_results() const noexcept -> const std::vector<result>& { return results; }
+
+        /// one row per benchmark, `vs std` is the median time relative to the `std` entry of the same group
+        auto print(std::ostream& os) const -> void {
+            const auto flags = os.flags();
+            os << std::left << std::setw(28) << "group" << std::setw(16) << "name" << std::right << std::setw(10) << "elements"
+               << std::setw(12) << "p50 ns/el" << std::setw(12) << "p90 ns/el" << std::setw(12) << "p99 ns/el"
+               << std::setw(12) << "cycles/el" << std::setw(10) << "vs std" << '\n';
+            os << std::fixed << std::setprecision(3);
+            for (const auto& r : results) {
+                os << std::left << std::setw(28) << r.group << std::setw(16) << r.name << std::right << std::setw(10) << r.elements
+                   << std::setw(12) << r.p50_ns << std::setw(12) << r.p90_ns << std::setw(12) << r.p99_ns << std::setw(12) << r.cycles;
+                if (const result* base = baseline(r); base != nullptr && base != &r && base->p50_ns > 0)
+                    os << std::setw(9) << r.p50_ns / base->p50_ns << 'x';
+                os << '\n';
+            }
+            os.flags(flags);
+        }
+
+        auto write_json(format::sink& out) const -> void {
+            out.write("{\"results\": [");
+            for (usize i = 0; i < results.size(); ++i) {
+                const auto& r = results[i];
+                out.write(i == 0 ? "\n  " : ",\n  ");
+                out.write("{\"group\": ");
+                write_string(out, r.group);
+                out.write(", \"name\": ");
+                write_string(out, r.name);
+                out << ", \"elements\": " << r.elements << ", \"runs\": " << r.runs
+                    << ", \"min_ns\": " << r.min_ns << ", \"mean_ns\": " << r.mean_ns
+                    << ", \"p50_ns\": " << r.p50_ns << ", \"p90_ns\": " << r.p90_ns << ", \"p99_ns\": " << r.p99_ns
+                    << ", \"cycles_per_element\": " << r.cycles << '}';
+            }
+            out.write("\n]}\n");
+        }
+
+        /// prints the table and writes the JSON report if one was requested
+        auto report(std::ostream& os) const -> void {
+            print(os);
+            if (opts.json.empty()) return;
+            format::file_sink out(opts.json);
+            write_json(out);
+        }
+
+    private:
+        options opts;
+        std::vector<result> results;
+
+        /// nearest-rank percentile of sorted samples
+        [[nodiscard]] static auto percentile(const std::vector<double>& sorted, const usize p) -> double {
+            const usize rank = (p * sorted.size() + 99) / 100;
+            return sorted[std::clamp<usize>(rank, 1, sorted.size()) - 1];
+        }
+        [[nodiscard]] auto baseline(const result& r) const -> const result* {
+            for (const auto& other : results)
+                if (other.group == r.group && other.name == "std") return &other;
+            return nullptr;
+        }
+        static auto write_string(format::sink& out, const std::string_view str) -> void {
+            out.put('"');
+            for (const char ch : str) {
+                if (ch == '"' || ch == '\\') out.put('\\');
+                out.put(ch);
+            }
+            out.put('"');
+        }
+    };
+}
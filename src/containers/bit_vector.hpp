@@ -0,0 +1,327 @@
+#pragma once
+
+#include <orc_export.hpp>
+#include <ordefs.hpp>
+#include <checks.hpp>
+#include <algorithm>
+#include <bit>
+#include <memory>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <vector>
+#include "format.hpp"
+#include "iterator.hpp"
+#include "optional.hpp"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define ORC_BITS_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ORC_BITS_SSE2
+#endif
+
+using namespace orc::core::defines;
+using namespace orc::iterators;
+
+namespace orc::containers {
+
+    enum class ORC_API _bit_op {
+        And,
+        Or,
+        Xor,
+        AndNot,
+    };
+
+    template<_bit_op Op>
+    [[nodiscard]] constexpr auto _apply_bits(const u64 l, const u64 r) noexcept -> u64 {
+        if constexpr (Op == _bit_op::And) return l & r;
+        else if constexpr (Op == _bit_op::Or) return l | r;
+        else if constexpr (Op == _bit_op::Xor) return l ^ r;
+        else return l & ~r;
+    }
+
+    /// `dst[i] = dst[i] op src[i]` over whole words, several words per instruction where available
+    template<_bit_op Op>
+    auto _apply_words(u64* dst, const u64* src, const usize n) noexcept -> void {
+        usize i = 0;
+#if defined(ORC_BITS_AVX2)
+        for (; i + 4 <= n; i += 4) {
+            const __m256i l = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+            const __m256i r = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+            __m256i res;
+            if constexpr (Op == _bit_op::And) res = _mm256_and_si256(l, r);
+            else if constexpr (Op == _bit_op::Or) res = _mm256_or_si256(l, r);
+            else if constexpr (Op == _bit_op::Xor) res = _mm256_xor_si256(l, r);
+            else res = _mm256_andnot_si256(r, l);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), res);
+        }
+#elif defined(ORC_BITS_SSE2)
+        for (; i + 2 <= n; i += 2) {
+            const __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+            const __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            __m128i res;
+            if constexpr (Op == _bit_op::And) res = _mm_and_si128(l, r);
+            else if constexpr (Op == _bit_op::Or) res = _mm_or_si128(l, r);
+            else if constexpr (Op == _bit_op::Xor) res = _mm_xor_si128(l, r);
+            else res = _mm_andnot_si128(r, l);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), res);
+        }
+#endif
+        for (; i < n; ++i) dst[i] = _apply_bits<Op>(dst[i], src[i]);
+    }
+
+    /// position of the `k`-th set bit of `word`, which must have more than `k` set bits
+    [[nodiscard]] constexpr auto _select_in_word(u64 word, usize k) noexcept -> usize {
+        for (; k > 0; --k) word &= word - 1;
+        return static_cast<usize>(std::countr_zero(word));
+    }
+
+    class bit_vector_ones;
+
+    /// bits packed into 64-bit words. bits past `size()` in the last word are always zero,
+    /// so whole-word popcounts and bitwise operations never see garbage
+    class ORC_API bit_vector {
+    public:
+        static constexpr usize WORD_BITS = 64;
+
+        bit_vector() = default;
+        explicit bit_vector(const usize n, const bool value = false) { resize(n, value); }
+        bit_vector(std::initializer_list<bool> init) {
+            for (const bool b : init) push(b);
+        }
+
+        [[nodiscard]] auto size() const noexcept -> usize { return len; }
+        [[nodiscard]] auto is_empty() const noexcept -> bool { return len == 0; }
+        [[nodiscard]] auto word_count() const noexcept -> usize { return words.size(); }
+        /// packed storage, bit `i` is bit `i % 64` of word `i / 64`
+        [[nodiscard]] auto as_words() const noexcept -> std::span<const u64> { return words; }
+
+        [[nodiscard]] auto get(const usize idx) const -> bool {
+            ORC_BOUNDS_CHECK(idx < len, "index out of range");
+            return (words[idx / WORD_BITS] >> (idx % WORD_BITS)) & 1;
+        }
+        [[nodiscard]] auto operator[](const usize idx) const -> bool { return get(idx); }
+        [[nodiscard]] auto get_unchecked(const usize idx) const -> bool {
+            ORC_DEBUG_CHECK(idx < len, "index out of range");
+            return (words[idx / WORD_BITS] >> (idx % WORD_BITS)) & 1;
+        }
+        auto set(const usize idx, const bool value) -> void {
+            ORC_BOUNDS_CHECK(idx < len, "index out of range");
+            const u64 mask = u64{1} << (idx % WORD_BITS);
+            u64& word = words[idx / WORD_BITS];
+            word = value ? word | mask : word & ~mask;
+        }
+        auto flip(const usize idx) -> void {
+            ORC_BOUNDS_CHECK(idx < len, "index out of range");
+            words[idx / WORD_BITS] ^= u64{1} << (idx % WORD_BITS);
+        }
+
+        auto push(const bool value) -> void {
+            if (len % WORD_BITS == 0) words.push_back(0);
+            words.back() |= static_cast<u64>(value) << (len % WORD_BITS);
+            len++;
+        }
+        [[nodiscard]] auto pop() -> bool {
+            if (len == 0) [[unlikely]] core::checks::_fail_out_of_range("empty bit vector");
+            const bool value = get(len - 1);
+            resize(len - 1);
+            return value;
+        }
+        auto resize(const usize n, const bool value = false) -> void {
+            const usize old = len;
+            words.resize((n + WORD_BITS - 1) / WORD_BITS, value ? ~u64{0} : 0);
+            len = n;
+            if (value && old < n && old % WORD_BITS != 0) words[old / WORD_BITS] |= ~u64{0} << (old % WORD_BITS);
+            clear_tail();
+        }
+        auto clear() noexcept -> void {
+            words.clear();
+            len = 0;
+        }
+        auto reserve(const usize bits) -> void { words.reserve((bits + WORD_BITS - 1) / WORD_BITS); }
+
+        /// number of set bits
+        [[nodiscard]] auto count_ones() const noexcept -> usize {
+            usize total = 0;
+            for (const u64 w : words) total += static_cast<usize>(std::popcount(w));
+            return total;
+        }
+        [[nodiscard]] auto count_zeros() const noexcept -> usize { return len - count_ones(); }
+        [[nodiscard]] auto any() const noexcept -> bool {
+            return std::any_of(words.begin(), words.end(), [](const u64 w) { return w != 0; });
+        }
+
+        auto operator&=(const bit_vector& other) -> bit_vector& { return apply<_bit_op::And>(other); }
+        auto operator|=(const bit_vector& other) -> bit_vector& { return apply<_bit_op::Or>(other); }
+        auto operator^=(const bit_vector& other) -> bit_vector& { return apply<_bit_op::Xor>(other); }
+        /// clears every bit set in `other`
+        auto and_not(const bit_vector& other) -> bit_vector& { return apply<_bit_op::AndNot>(other); }
+        auto flip_all() noexcept -> void {
+            for (u64& w : words) w = ~w;
+            clear_tail();
+        }
+
+        [[nodiscard]] friend auto operator&(bit_vector l, const bit_vector& r) -> bit_vector { return std::move(l &= r); }
+        [[nodiscard]] friend auto operator|(bit_vector l, const bit_vector& r) -> bit_vector { return std::move(l |= r); }
+        [[nodiscard]] friend auto operator^(bit_vector l, const bit_vector& r) -> bit_vector { return std::move(l ^= r); }
+        [[nodiscard]] friend auto operator~(bit_vector v) -> bit_vector {
+            v.flip_all();
+            return v;
+        }
+        [[nodiscard]] auto operator==(const bit_vector& other) const noexcept -> bool = default;
+
+        /// positions of the set bits in increasing order
+        [[nodiscard]] auto ones() const -> bit_vector_ones;
+
+        auto format_to(format::sink& out) const -> void {
+            for (usize i = 0; i < len; ++i) out.put(((words[i / WORD_BITS] >> (i % WORD_BITS)) & 1) ? '1' : '0');
+        }
+        auto print(std::ostream& os) const -> void {
+            format::ostream_sink out(os);
+            format_to(out);
+        }
+        friend auto operator<<(std::ostream& os, const bit_vector& obj) -> std::ostream& {
+            obj.print(os);
+            return os;
+        }
+
+        [[nodiscard]] static auto from_iter(std::unique_ptr<iterator<bool>> iter) -> bit_vector {
+            bit_vector a;
+            foreach(i, (*iter), {
+                a.push(i);
+            })
+            return a;
+        }
+
+    private:
+        std::vector<u64> words;
+        usize len = 0;
+
+        auto clear_tail() noexcept -> void {
+            if (len % WORD_BITS != 0) words.back() &= ~u64{0} >> (WORD_BITS - len % WORD_BITS);
+        }
+        template<_bit_op Op>
+        auto apply(const bit_vector& other) -> bit_vector& {
+            if (len != other.len) throw std::invalid_argument("bit vector sizes do not match");
+            _apply_words<Op>(words.data(), other.words.data(), words.size());
+            return *this;
+        }
+    };
+
+    /// orc iterator over the positions of set bits, skips whole zero words
+    class ORC_API bit_vector_ones final : public iterator<usize> {
+    public:
+        explicit bit_vector_ones(const bit_vector& bits) : words(bits.as_words()) {
+            if (!words.empty()) current = words[0];
+        }
+        auto clone() const -> std::unique_ptr<iterator<usize>> override {
+            ORC_RECORD(bit_vector_ones, IteratorClone, 1);
+            return std::make_unique<bit_vector_ones>(*this);
+        }
+        [[nodiscard]] auto has_next() const noexcept -> bool override {
+            if (current != 0) return true;
+            for (usize w = word + 1; w < words.size(); ++w)
+                if (words[w] != 0) return true;
+            return false;
+        }
+        [[nodiscard]] auto next() -> usize override {
+            if (!seek()) _end_iteration<bit_vector_ones>();
+            return take();
+        }
+        [[nodiscard]] auto try_next() -> orc::optional::optional<usize> override {
+            if (!seek()) return orc::optional::none;
+            return orc::optional::some(take());
+        }
+    private:
+        std::span<const u64> words;
+        usize word = 0;
+        u64 current = 0;
+
+        auto seek() noexcept -> bool {
+            while (current == 0) {
+                if (word + 1 >= words.size()) return false;
+                current = words[++word];
+            }
+            return true;
+        }
+        auto take() noexcept -> usize {
+            const usize pos = word * bit_vector::WORD_BITS + static_cast<usize>(std::countr_zero(current));
+            current &= current - 1;
+            return pos;
+        }
+    };
+
+    inline auto bit_vector::ones() const -> bit_vector_ones { return bit_vector_ones(*this); }
+
+    /// rank/select directory over an unchanging `bit_vector`, one count per 512-bit block (12.5%) plus the select samples.
+    /// `rank` is a block lookup and up to `BLOCK_WORDS` popcounts within that block, `select` a binary search over
+    /// sampled blocks. it has to be rebuilt after the vector changes
+    class ORC_API rank_select {
+    public:
+        /// bits per block, one cumulative count is stored per block
+        static constexpr usize BLOCK_BITS = 512;
+        static constexpr usize BLOCK_WORDS = BLOCK_BITS / bit_vector::WORD_BITS;
+        /// one in every `SELECT_SAMPLE` set bits remembers its block
+        static constexpr usize SELECT_SAMPLE = 4096;
+
+        explicit rank_select(const bit_vector& bits) : words(bits.as_words()), len(bits.size()) {
+            const usize blocks = (words.size() + BLOCK_WORDS - 1) / BLOCK_WORDS;
+            block_ranks.reserve(blocks + 1);
+            usize total = 0;
+            for (usize b = 0; b < blocks; ++b) {
+                block_ranks.push_back(total);
+                const usize end = std::min<usize>(words.size(), (b + 1) * BLOCK_WORDS);
+                for (usize w = b * BLOCK_WORDS; w < end; ++w) {
+                    const usize ones = static_cast<usize>(std::popcount(words[w]));
+                    // the sample for set bit k points at the block holding it
+                    while (samples.size() * SELECT_SAMPLE < total + ones) samples.push_back(b);
+                    total += ones;
+                }
+            }
+            block_ranks.push_back(total);
+        }
+
+        [[nodiscard]] auto size() const noexcept -> usize { return len; }
+        [[nodiscard]] auto count_ones() const noexcept -> usize { return block_ranks.back(); }
+
+        /// set bits in `[0, idx)`
+        [[nodiscard]] auto rank(const usize idx) const -> usize {
+            if (idx > len) [[unlikely]] core::checks::_fail_out_of_range("index out of range");
+            const usize word = idx / bit_vector::WORD_BITS;
+            usize total = block_ranks[word / BLOCK_WORDS];
+            for (usize w = word / BLOCK_WORDS * BLOCK_WORDS; w < word; ++w) total += static_cast<usize>(std::popcount(words[w]));
+            if (const usize bit = idx % bit_vector::WORD_BITS; bit != 0)
+                total += static_cast<usize>(std::popcount(words[word] & (~u64{0} >> (bit_vector::WORD_BITS - bit))));
+            return total;
+        }
+        /// unset bits in `[0, idx)`
+        [[nodiscard]] auto rank0(const usize idx) const -> usize { return idx - rank(idx); }
+
+        /// position of the `k`-th set bit, counting from 0
+        [[nodiscard]] auto select(usize k) const -> orc::optional::optional<usize> {
+            if (k >= count_ones()) return orc::optional::none;
+            // the blocks between two samples hold at most `SELECT_SAMPLE` set bits
+            usize lo = samples[k / SELECT_SAMPLE];
+            usize hi = k / SELECT_SAMPLE + 1 < samples.size() ? samples[k / SELECT_SAMPLE + 1] + 1 : block_ranks.size() - 1;
+            while (hi - lo > 1) {
+                const usize mid = lo + (hi - lo) / 2;
+                if (block_ranks[mid] <= k) lo = mid;
+                else hi = mid;
+            }
+            k -= block_ranks[lo];
+            for (usize w = lo * BLOCK_WORDS;; ++w) {
+                const usize ones = static_cast<usize>(std::popcount(words[w]));
+                if (k < ones) return orc::optional::some(w * bit_vector::WORD_BITS + _select_in_word(words[w], k));
+                k -= ones;
+            }
+        }
+
+    private:
+        std::span<const u64> words;
+        usize len;
+        std::vector<usize> block_ranks;
+        std::vector<usize> samples;
+    };
+}
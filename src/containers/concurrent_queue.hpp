@@ -0,0 +1,238 @@
+#pragma once
+
+#include <orc_export.hpp>
+#include <ordefs.hpp>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include "optional.hpp"
+
+using namespace orc::core::defines;
+
+namespace orc::containers {
+
+    /// assumed size of a cache line, fields written by different threads are kept this far apart
+    ORC_API inline constexpr usize CACHE_LINE = 64;
+
+    template<typename T>
+    struct ORC_API _raw_slot {
+        alignas(T) std::byte bytes[sizeof(T)];
+
+        [[nodiscard]] auto get() noexcept -> T* { return std::launder(reinterpret_cast<T*>(bytes)); }
+        template<typename... Args>
+        auto construct(Args&&... args) -> void { std::construct_at(reinterpret_cast<T*>(bytes), std::forward<Args>(args)...); }
+        [[nodiscard]] auto take() -> T {
+            T tmp = std::move(*get());
+            std::destroy_at(get());
+            return tmp;
+        }
+    };
+
+    /// bounded lock-free queue for exactly one producer thread and one consumer thread.
+    /// `N` must be a power of two, storage is inline
+    template<typename T, usize N>
+    class ORC_API spsc_queue {
+        static_assert(N >= 2 && std::has_single_bit(N), "queue capacity must be a power of two");
+        static_assert(std::is_nothrow_move_constructible_v<T>, "queued values are moved without rollback");
+    public:
+        spsc_queue() = default;
+        spsc_queue(const spsc_queue&) = delete;
+        auto operator=(const spsc_queue&) -> spsc_queue& = delete;
+        ~spsc_queue() {
+            for (usize i = consumer.pos; i != producer.pos; ++i) std::destroy_at(slots[i & MASK].get());
+        }
+
+        [[nodiscard]] static constexpr auto capacity() noexcept -> usize { return N; }
+        /// approximate while other threads are running
+        [[nodiscard]] auto size() const noexcept -> usize {
+            return producer.pos_atomic.load(std::memory_order_acquire) - consumer.pos_atomic.load(std::memory_order_acquire);
+        }
+
+        /// producer side, returns false when full
+        auto try_push(T value) -> bool {
+            const usize pos = producer.pos;
+            if (pos - producer.cached_other == N) {
+                producer.cached_other = consumer.pos_atomic.load(std::memory_order_acquire);
+                if (pos - producer.cached_other == N) return false;
+            }
+            slots[pos & MASK].construct(std::move(value));
+            producer.pos = pos + 1;
+            producer.pos_atomic.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+        /// producer side, pushes a prefix of `values` and returns its length
+        auto push_batch(const std::span<const T> values) -> usize {
+            const usize pos = producer.pos;
+            usize free = N - (pos - producer.cached_other);
+            if (free < values.size()) {
+                producer.cached_other = consumer.pos_atomic.load(std::memory_order_acquire);
+                free = N - (pos - producer.cached_other);
+            }
+            const usize count = std::min<usize>(free, values.size());
+            for (usize i = 0; i < count; ++i) slots[(pos + i) & MASK].construct(values[i]);
+            // one release store publishes the whole batch
+            producer.pos = pos + count;
+            producer.pos_atomic.store(pos + count, std::memory_order_release);
+            return count;
+        }
+
+        /// consumer side
+        [[nodiscard]] auto try_pop() -> orc::optional::optional<T> {
+            const usize pos = consumer.pos;
+            if (pos == consumer.cached_other) {
+                consumer.cached_other = producer.pos_atomic.load(std::memory_order_acquire);
+                if (pos == consumer.cached_other) return orc::optional::none;
+            }
+            T value = slots[pos & MASK].take();
+            consumer.pos = pos + 1;
+            consumer.pos_atomic.store(pos + 1, std::memory_order_release);
+            return orc::optional::some(std::move(value));
+        }
+        /// consumer side, fills a prefix of `out` and returns its length
+        auto pop_batch(const std::span<T> out) -> usize {
+            const usize pos = consumer.pos;
+            usize available = consumer.cached_other - pos;
+            if (available < out.size()) {
+                consumer.cached_other = producer.pos_atomic.load(std::memory_order_acquire);
+                available = consumer.cached_other - pos;
+            }
+            const usize count = std::min<usize>(available, out.size());
+            for (usize i = 0; i < count; ++i) out[i] = slots[(pos + i) & MASK].take();
+            consumer.pos = pos + count;
+            consumer.pos_atomic.store(pos + count, std::memory_order_release);
+            return count;
+        }
+
+    private:
+        static constexpr usize MASK = N - 1;
+
+        /// `pos` is the owner's private copy, `cached_other` the last seen position of the other side
+        struct alignas(CACHE_LINE) side {
+            std::atomic<usize> pos_atomic{0};
+            usize pos = 0;
+            usize cached_other = 0;
+        };
+        side producer;
+        side consumer;
+        alignas(CACHE_LINE) _raw_slot<T> slots[N];
+    };
+
+    /// bounded lock-free queue for any number of producers and consumers, based on per-slot sequence numbers.
+    /// `N` must be a power of two, storage is inline
+    template<typename T, usize N>
+    class ORC_API mpmc_queue {
+        static_assert(N >= 2 && std::has_single_bit(N), "queue capacity must be a power of two");
+        static_assert(std::is_nothrow_move_constructible_v<T>, "queued values are moved without rollback");
+    public:
+        mpmc_queue() {
+            for (usize i = 0; i < N; ++i) cells[i].seq.store(i, std::memory_order_relaxed);
+        }
+        mpmc_queue(const mpmc_queue&) = delete;
+        auto operator=(const mpmc_queue&) -> mpmc_queue& = delete;
+        ~mpmc_queue() {
+            const usize tail = enqueue_pos.load(std::memory_order_relaxed);
+            for (usize i = dequeue_pos.load(std::memory_order_relaxed); i != tail; ++i) std::destroy_at(cells[i & MASK].slot.get());
+        }
+
+        [[nodiscard]] static constexpr auto capacity() noexcept -> usize { return N; }
+        /// approximate while other threads are running
+        [[nodiscard]] auto size() const noexcept -> usize {
+            const usize head = dequeue_pos.load(std::memory_order_acquire);
+            const usize tail = enqueue_pos.load(std::memory_order_acquire);
+            return tail > head ? tail - head : 0;
+        }
+
+        auto try_push(T value) -> bool {
+            usize count = 1;
+            const usize pos = claim(enqueue_pos, count, 0);
+            if (pos == npos) return false;
+            publish(pos, std::move(value));
+            return true;
+        }
+        /// pushes a prefix of `values` with a single claim on the shared position, returns its length
+        auto push_batch(const std::span<const T> values) -> usize {
+            // `claim` needs at least one position to tell a full queue from a lost race
+            if (values.empty()) return 0;
+            usize count = values.size();
+            const usize pos = claim(enqueue_pos, count, 0);
+            if (pos == npos) return 0;
+            for (usize i = 0; i < count; ++i) publish(pos + i, values[i]);
+            return count;
+        }
+
+        [[nodiscard]] auto try_pop() -> orc::optional::optional<T> {
+            usize count = 1;
+            const usize pos = claim(dequeue_pos, count, 1);
+            if (pos == npos) return orc::optional::none;
+            return orc::optional::some(consume(pos));
+        }
+        /// pops into a prefix of `out` with a single claim on the shared position, returns its length
+        auto pop_batch(const std::span<T> out) -> usize {
+            if (out.empty()) return 0;
+            usize count = out.size();
+            const usize pos = claim(dequeue_pos, count, 1);
+            if (pos == npos) return 0;
+            for (usize i = 0; i < count; ++i) out[i] = consume(pos + i);
+            return count;
+        }
+
+    private:
+        static constexpr usize MASK = N - 1;
+        static constexpr usize npos = static_cast<usize>(-1);
+
+        /// `seq == pos` means free for the producer of `pos`, `seq == pos + 1` means filled for its consumer
+        struct alignas(CACHE_LINE) cell {
+            std::atomic<usize> seq;
+            _raw_slot<T> slot;
+        };
+
+        alignas(CACHE_LINE) std::atomic<usize> enqueue_pos{0};
+        alignas(CACHE_LINE) std::atomic<usize> dequeue_pos{0};
+        cell cells[N];
+
+        /// reserves up to `count` consecutive positions that are ready (`seq == pos + lag`), shrinking `count`
+        /// to what was reserved. returns the first position or `npos` when none is ready
+        [[nodiscard]] auto claim(std::atomic<usize>& shared, usize& count, const usize lag) noexcept -> usize {
+            const usize wanted = count;
+            usize pos = shared.load(std::memory_order_relaxed);
+            for (;;) {
+                usize ready = 0;
+                while (ready < wanted && ready < N) {
+                    const usize seq = cells[(pos + ready) & MASK].seq.load(std::memory_order_acquire);
+                    if (seq != pos + ready + lag) break;
+                    ready++;
+                }
+                if (ready == 0) {
+                    const usize seq = cells[pos & MASK].seq.load(std::memory_order_acquire);
+                    // behind: the queue is full (producers) or empty (consumers); ahead: another thread won the slot
+                    if (static_cast<isize>(seq - (pos + lag)) < 0) return npos;
+                    pos = shared.load(std::memory_order_relaxed);
+                    continue;
+                }
+                if (shared.compare_exchange_weak(pos, pos + ready, std::memory_order_relaxed)) {
+                    count = ready;
+                    return pos;
+                }
+            }
+        }
+
+        template<typename U>
+        auto publish(const usize pos, U&& value) -> void {
+            cell& c = cells[pos & MASK];
+            c.slot.construct(std::forward<U>(value));
+            c.seq.store(pos + 1, std::memory_order_release);
+        }
+        auto consume(const usize pos) -> T {
+            cell& c = cells[pos & MASK];
+            T value = c.slot.take();
+            c.seq.store(pos + N, std::memory_order_release);
+            return value;
+        }
+    };
+}
@@ -0,0 +1,214 @@
+#pragma once
+
+#include <orc_export.hpp>
+#include <ordefs.hpp>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+#include "iterator.hpp"
+#include "format.hpp"
+#include "hash.hpp"
+#include "raw_hash_table.hpp"
+
+using namespace orc::core::defines;
+using namespace orc::iterators;
+
+namespace orc::containers {
+
+    template<typename K, typename V>
+    struct _pair_key {
+        [[nodiscard]] constexpr auto operator()(const std::pair<K, V>& slot) const noexcept -> const K& { return slot.first; }
+    };
+
+    /// open-addressing hash map with swiss-table style group probing.
+    /// entries are stored inline as `std::pair<K, V>`, keys must not be modified through iteration
+    template<typename K, typename V, typename Hash = hash::default_hash<K>, typename Eq = std::equal_to<K>,
+             class Alloc = std::allocator<std::pair<K, V>>>
+    class ORC_API flat_hash_map {
+        using table_t = _raw_hash_table<K, std::pair<K, V>, _pair_key<K, V>, Hash, Eq, Alloc>;
+    public:
+        using value_type = std::pair<K, V>;
+
+        template<bool Const>
+        class basic_iterator {
+        public:
+            using table_ptr = std::conditional_t<Const, const table_t*, table_t*>;
+            using reference = std::conditional_t<Const, const value_type&, value_type&>;
+            using difference_type = isize;
+
+            basic_iterator() = default;
+            basic_iterator(table_ptr table, const usize idx) : table(table), idx(idx) { skip_free(); }
+            [[nodiscard]] auto operator*() const -> reference { return table->slot(idx); }
+            [[nodiscard]] auto operator->() const -> std::remove_reference_t<reference>* { return &table->slot(idx); }
+            auto operator++() -> basic_iterator& {
+                idx++;
+                skip_free();
+                return *this;
+            }
+            auto operator++(int) -> basic_iterator {
+                auto tmp = *this;
+                ++*this;
+                return tmp;
+            }
+            [[nodiscard]] auto operator==(const basic_iterator& other) const noexcept -> bool { return idx == other.idx; }
+        private:
+            table_ptr table = nullptr;
+            usize idx = 0;
+
+            auto skip_free() -> void {
+                while (idx < table->slot_count() && !table->is_full(idx)) idx++;
+            }
+        };
+        using iterator = basic_iterator<false>;
+        using const_iterator = basic_iterator<true>;
+
+        flat_hash_map() = default;
+        explicit flat_hash_map(const usize initial_cap) { table.reserve(initial_cap); }
+        flat_hash_map(std::initializer_list<value_type> init) {
+            table.reserve(init.size());
+            for (const auto& [k, v] : init) insert(k, v);
+        }
+
+        [[nodiscard]] auto size() const noexcept -> usize { return table.size(); }
+        [[nodiscard]] auto is_empty() const noexcept -> bool { return table.is_empty(); }
+        [[nodiscard]] auto capacity() const noexcept -> usize { return table.capacity(); }
+        auto reserve(const usize n) -> void { table.reserve(n); }
+        auto rehash(const usize n) -> void { table.rehash(n); }
+        auto clear() -> void { table.clear(); }
+
+        /// `nullptr` when the key is absent; any `Q` is accepted when `Hash` and `Eq` are transparent
+        template<typename Q = K>
+        requires _key_arg<Q, K, Hash, Eq>
+        [[nodiscard]] auto find(const Q& key) -> V* {
+            const usize idx = lookup(key);
+            return idx == table_t::npos ? nullptr : &table.slot(idx).second;
+        }
+        template<typename Q = K>
+        requires _key_arg<Q, K, Hash, Eq>
+        [[nodiscard]] auto find(const Q& key) const -> const V* {
+            const usize idx = lookup(key);
+            return idx == table_t::npos ? nullptr : &table.slot(idx).second;
+        }
+        template<typename Q = K>
+        requires _key_arg<Q, K, Hash, Eq>
+        [[nodiscard]] auto contains(const Q& key) const -> bool { return lookup(key) != table_t::npos; }
+        template<typename Q = K>
+        requires _key_arg<Q, K, Hash, Eq>
+        [[nodiscard]] auto get(const Q& key) -> V& {
+            if (V* v = find(key); v != nullptr) [[likely]] return *v;
+            throw std::out_of_range("key not found");
+        }
+        template<typename Q = K>
+        requires _key_arg<Q, K, Hash, Eq>
+        [[nodiscard]] auto get(const Q& key) const -> const V& {
+            if (const V* v = find(key); v != nullptr) [[likely]] return *v;
+            throw std::out_of_range("key not found");
+        }
+
+        /// inserts unless the key is present, returns whether it was inserted
+        template<typename KK, typename... Args>
+        auto emplace(KK&& key, Args&&... args) -> bool {
+            const u64 h = table.hash_of(key);
+            if (table.find_index(key, h) != table_t::npos) return false;
+            table.emplace_unique(h, std::piecewise_construct,
+                                 std::forward_as_tuple(std::forward<KK>(key)),
+                                 std::forward_as_tuple(std::forward<Args>(args)...));
+            return true;
+        }
+        auto insert(K key, V value) -> bool { return emplace(std::move(key), std::move(value)); }
+        auto insert_or_assign(K key, V value) -> void {
+            const u64 h = table.hash_of(key);
+            if (const usize idx = table.find_index(key, h); idx != table_t::npos) {
+                table.slot(idx).second = std::move(value);
+                return;
+            }
+            table.emplace_unique(h, std::move(key), std::move(value));
+        }
+        /// default-constructs the value when the key is absent
+        auto operator[](const K& key) -> V& {
+            const u64 h = table.hash_of(key);
+            usize idx = table.find_index(key, h);
+            if (idx == table_t::npos)
+                idx = table.emplace_unique(h, std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple());
+            return table.slot(idx).second;
+        }
+        template<typename Q = K>
+        requires _key_arg<Q, K, Hash, Eq>
+        auto remove(const Q& key) -> bool {
+            const usize idx = lookup(key);
+            if (idx == table_t::npos) return false;
+            table.erase_index(idx);
+            return true;
+        }
+
+        [[nodiscard]] auto begin() -> iterator { return iterator(&table, 0); }
+        [[nodiscard]] auto end() -> iterator { return iterator(&table, table.slot_count()); }
+        [[nodiscard]] auto begin() const -> const_iterator { return const_iterator(&table, 0); }
+        [[nodiscard]] auto end() const -> const_iterator { return const_iterator(&table, table.slot_count()); }
+
+        auto format_to(format::sink& out) const -> void {
+            out.put('{');
+            bool first = true;
+            for (const auto& [k, v] : *this) {
+                if (!first) out.write(", ");
+                format::format_to(out, k);
+                out.write(": ");
+                format::format_to(out, v);
+                first = false;
+            }
+            out.put('}');
+        }
+        auto print(std::ostream& os) const -> void {
+            format::ostream_sink out(os);
+            format_to(out);
+        }
+        friend auto operator<<(std::ostream& os, const flat_hash_map& map) -> std::ostream& {
+            map.print(os);
+            return os;
+        }
+
+        [[nodiscard]] static auto from_iter(std::unique_ptr<orc::iterators::iterator<value_type>> iter) -> flat_hash_map {
+            flat_hash_map map;
+            foreach(entry, (*iter), {
+                map.insert_or_assign(std::move(entry.first), std::move(entry.second));
+            })
+            return map;
+        }
+
+    private:
+        table_t table;
+
+        template<typename Q>
+        [[nodiscard]] auto lookup(const Q& key) const -> usize {
+            // without transparent functors the key is converted once instead of on every probe
+            if constexpr (_transparent<Hash, Eq>) return table.find_index(key);
+            else return table.find_index(static_cast<const K&>(key));
+        }
+    };
+
+    template<typename K, typename V, typename Hash = hash::default_hash<K>, typename Eq = std::equal_to<K>,
+             class Alloc = std::allocator<std::pair<K, V>>>
+    class ORC_API flat_hash_map_iterator final : public orc::iterators::iterator<std::pair<K, V>> {
+    public:
+        using map_t = flat_hash_map<K, V, Hash, Eq, Alloc>;
+        explicit flat_hash_map_iterator(const map_t& map) : pos(map.begin()), last(map.end()) {}
+        auto clone() const -> std::unique_ptr<orc::iterators::iterator<std::pair<K, V>>> override {
+            ORC_RECORD(flat_hash_map_iterator, IteratorClone, 1);
+            return std::make_unique<flat_hash_map_iterator>(*this);
+        }
+        [[nodiscard]] auto has_next() const noexcept -> bool override { return !(pos == last); }
+        [[nodiscard]] auto next() -> std::pair<K, V> override {
+            if (!has_next()) _end_iteration<flat_hash_map_iterator>();
+            return *pos++;
+        }
+        [[nodiscard]] auto try_next() -> orc::optional::optional<std::pair<K, V>> override {
+            if (!has_next()) return orc::optional::none;
+            return orc::optional::some(*pos++);
+        }
+    private:
+        typename map_t::const_iterator pos;
+        typename map_t::const_iterator last;
+    };
+}
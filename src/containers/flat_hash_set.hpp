@@ -0,0 +1,163 @@
+#pragma once
+
+#include <orc_export.hpp>
+#include <ordefs.hpp>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <utility>
+#include "iterator.hpp"
+#include "format.hpp"
+#include "hash.hpp"
+#include "raw_hash_table.hpp"
+
+using namespace orc::core::defines;
+using namespace orc::iterators;
+
+namespace orc::containers {
+
+    struct _identity_key {
+        template<typename T>
+        [[nodiscard]] constexpr auto operator()(const T& slot) const noexcept -> const T& { return slot; }
+    };
+
+    /// open-addressing hash set with swiss-table style group probing, see `flat_hash_map`
+    template<typename T, typename Hash = hash::default_hash<T>, typename Eq = std::equal_to<T>, class Alloc = std::allocator<T>>
+    class ORC_API flat_hash_set {
+        using table_t = _raw_hash_table<T, T, _identity_key, Hash, Eq, Alloc>;
+    public:
+        using value_type = T;
+
+        class const_iterator {
+        public:
+            using difference_type = isize;
+
+            const_iterator() = default;
+            const_iterator(const table_t* table, const usize idx) : table(table), idx(idx) { skip_free(); }
+            [[nodiscard]] auto operator*() const -> const T& { return table->slot(idx); }
+            [[nodiscard]] auto operator->() const -> const T* { return &table->slot(idx); }
+            auto operator++() -> const_iterator& {
+                idx++;
+                skip_free();
+                return *this;
+            }
+            auto operator++(int) -> const_iterator {
+                auto tmp = *this;
+                ++*this;
+                return tmp;
+            }
+            [[nodiscard]] auto operator==(const const_iterator& other) const noexcept -> bool { return idx == other.idx; }
+        private:
+            const table_t* table = nullptr;
+            usize idx = 0;
+
+            auto skip_free() -> void {
+                while (idx < table->slot_count() && !table->is_full(idx)) idx++;
+            }
+        };
+
+        flat_hash_set() = default;
+        explicit flat_hash_set(const usize initial_cap) { table.reserve(initial_cap); }
+        flat_hash_set(std::initializer_list<T> init) {
+            table.reserve(init.size());
+            for (const auto& t : init) insert(t);
+        }
+
+        [[nodiscard]] auto size() const noexcept -> usize { return table.size(); }
+        [[nodiscard]] auto is_empty() const noexcept -> bool { return table.is_empty(); }
+        [[nodiscard]] auto capacity() const noexcept -> usize { return table.capacity(); }
+        auto reserve(const usize n) -> void { table.reserve(n); }
+        auto rehash(const usize n) -> void { table.rehash(n); }
+        auto clear() -> void { table.clear(); }
+
+        /// `nullptr` when absent; any `Q` is accepted when `Hash` and `Eq` are transparent
+        template<typename Q = T>
+        requires _key_arg<Q, T, Hash, Eq>
+        [[nodiscard]] auto find(const Q& key) const -> const T* {
+            const usize idx = lookup(key);
+            return idx == table_t::npos ? nullptr : &table.slot(idx);
+        }
+        template<typename Q = T>
+        requires _key_arg<Q, T, Hash, Eq>
+        [[nodiscard]] auto contains(const Q& key) const -> bool { return lookup(key) != table_t::npos; }
+
+        /// returns whether the value was inserted
+        auto insert(T value) -> bool {
+            const u64 h = table.hash_of(value);
+            if (table.find_index(value, h) != table_t::npos) return false;
+            table.emplace_unique(h, std::move(value));
+            return true;
+        }
+        template<typename Q = T>
+        requires _key_arg<Q, T, Hash, Eq>
+        auto remove(const Q& key) -> bool {
+            const usize idx = lookup(key);
+            if (idx == table_t::npos) return false;
+            table.erase_index(idx);
+            return true;
+        }
+
+        [[nodiscard]] auto begin() const -> const_iterator { return const_iterator(&table, 0); }
+        [[nodiscard]] auto end() const -> const_iterator { return const_iterator(&table, table.slot_count()); }
+
+        auto format_to(format::sink& out) const -> void {
+            out.put('{');
+            bool first = true;
+            for (const auto& t : *this) {
+                if (!first) out.write(", ");
+                format::format_to(out, t);
+                first = false;
+            }
+            out.put('}');
+        }
+        auto print(std::ostream& os) const -> void {
+            format::ostream_sink out(os);
+            format_to(out);
+        }
+        friend auto operator<<(std::ostream& os, const flat_hash_set& set) -> std::ostream& {
+            set.print(os);
+            return os;
+        }
+
+        [[nodiscard]] static auto from_iter(std::unique_ptr<orc::iterators::iterator<T>> iter) -> flat_hash_set {
+            flat_hash_set set;
+            foreach(t, (*iter), {
+                set.insert(std::move(t));
+            })
+            return set;
+        }
+
+    private:
+        table_t table;
+
+        template<typename Q>
+        [[nodiscard]] auto lookup(const Q& key) const -> usize {
+            // without transparent functors the key is converted once instead of on every probe
+            if constexpr (_transparent<Hash, Eq>) return table.find_index(key);
+            else return table.find_index(static_cast<const T&>(key));
+        }
+    };
+
+    template<typename T, typename Hash = hash::default_hash<T>, typename Eq = std::equal_to<T>, class Alloc = std::allocator<T>>
+    class ORC_API flat_hash_set_iterator final : public orc::iterators::iterator<T> {
+    public:
+        using set_t = flat_hash_set<T, Hash, Eq, Alloc>;
+        explicit flat_hash_set_iterator(const set_t& set) : pos(set.begin()), last(set.end()) {}
+        auto clone() const -> std::unique_ptr<orc::iterators::iterator<T>> override {
+            ORC_RECORD(flat_hash_set_iterator, IteratorClone, 1);
+            return std::make_unique<flat_hash_set_iterator>(*this);
+        }
+        [[nodiscard]] auto has_next() const noexcept -> bool override { return !(pos == last); }
+        [[nodiscard]] auto next() -> T override {
+            if (!has_next()) _end_iteration<flat_hash_set_iterator>();
+            return *pos++;
+        }
+        [[nodiscard]] auto try_next() -> orc::optional::optional<T> override {
+            if (!has_next()) return orc::optional::none;
+            return orc::optional::some(*pos++);
+        }
+    private:
+        typename set_t::const_iterator pos;
+        typename set_t::const_iterator last;
+    };
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <orc_export.hpp>
+#include <ordefs.hpp>
+#include <checks.hpp>
+#include <container.hpp>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include "mapped_file.hpp"
+
+using namespace orc::core::container;
+using namespace orc::core::defines;
+
+namespace orc::containers {
+
+    /// file header of `mmap_vector`, elements start at `DATA_OFFSET`
+    struct ORC_API _mmap_vector_header {
+        static constexpr u64 MAGIC = 0x3143455643524F; // "ORCVEC1"
+        static constexpr usize DATA_OFFSET = 64;
+        u64 magic;
+        u64 element_size;
+        u64 len;
+    };
+
+    /// vector of trivially copyable values stored in a memory-mapped file.
+    /// the file outlives the process, reopening it gives back the same elements without parsing or copying.
+    /// pointers and references into the vector are invalidated by any growth
+    template<typename T>
+    class ORC_API mmap_vector final : public stack_container<T> {
+        static_assert(std::is_trivially_copyable_v<T>, "mmap_vector elements are stored as raw bytes");
+        static_assert(alignof(T) <= _mmap_vector_header::DATA_OFFSET, "element alignment exceeds the data offset");
+        using header = _mmap_vector_header;
+    public:
+        /// opens `path`, creating an empty vector when the file is missing or empty
+        explicit mmap_vector(const std::string& path) : file(path, core::map_mode::ReadWrite) {
+            if (file.size() == 0) {
+                file.resize(header::DATA_OFFSET + sizeof(T) * 4);
+                *hdr() = header{header::MAGIC, sizeof(T), 0};
+                return;
+            }
+            if (file.size() < header::DATA_OFFSET || hdr()->magic != header::MAGIC) throw std::runtime_error("not an mmap_vector file");
+            if (hdr()->element_size != sizeof(T)) throw std::runtime_error("mmap_vector element size mismatch");
+            if (hdr()->len > capacity()) throw std::runtime_error("mmap_vector file is truncated");
+        }
+
+        [[nodiscard]] constexpr auto size() const noexcept -> usize override { return hdr()->len; }
+        [[nodiscard]] constexpr auto is_empty() const noexcept -> bool override { return size() == 0; }
+        [[nodiscard]] auto capacity() const noexcept -> usize { return (file.size() - header::DATA_OFFSET) / sizeof(T); }
+
+        [[nodiscard]] auto get(const usize idx) const -> const T& override {
+            ORC_BOUNDS_CHECK(idx < size(), "index out of range");
+            return data()[idx];
+        }
+        [[nodiscard]] auto get(const usize idx) -> T& override {
+            ORC_BOUNDS_CHECK(idx < size(), "index out of range");
+            return data()[idx];
+        }
+        [[nodiscard]] auto operator[](const usize idx) const -> const T& override { return get(idx); }
+        [[nodiscard]] auto operator[](const usize idx) -> T& override { return get(idx); }
+        [[nodiscard]] auto get_unchecked(const usize idx) const -> const T& {
+            ORC_DEBUG_CHECK(idx < size(), "index out of range");
+            return data()[idx];
+        }
+        [[nodiscard]] auto get_unchecked(const usize idx) -> T& {
+            ORC_DEBUG_CHECK(idx < size(), "index out of range");
+            return data()[idx];
+        }
+        auto set(const usize idx, const T& value) -> void override { get(idx) = value; }
+
+        [[nodiscard]] auto top() const -> const T& override { return get(size() - 1); }
+        [[nodiscard]] auto top() -> T& override { return get(size() - 1); }
+        auto push(const T& value) -> void override {
+            const usize len = size();
+            // `value` may live in the mapping, which growth unmaps
+            const T copy = value;
+            if (len == capacity()) reserve(std::max<usize>(4, len * 2));
+            std::memcpy(data() + len, &copy, sizeof(T));
+            hdr()->len = len + 1;
+        }
+        /// appends all of `values` with a single copy, `values` may be a range of this vector
+        auto push(std::span<const T> values) -> void {
+            const usize len = size();
+            if (len + values.size() > capacity()) {
+                const usize at = values.empty() ? len : index_of(values.data());
+                reserve(std::max<usize>(len * 2, len + values.size()));
+                if (at != len) values = {data() + at, values.size()};
+            }
+            if (!values.empty()) std::memcpy(data() + len, values.data(), values.size_bytes());
+            hdr()->len = len + values.size();
+        }
+        [[nodiscard]] auto pop() -> T override {
+            const usize len = size();
+            if (len == 0) [[unlikely]] core::checks::_fail_out_of_range("empty vector");
+            hdr()->len = len - 1;
+            return data()[len - 1];
+        }
+        auto clear() noexcept -> void { hdr()->len = 0; }
+
+        /// grows the file so that `n` elements fit without remapping
+        auto reserve(const usize n) -> void {
+            if (n > capacity()) file.resize(header::DATA_OFFSET + n * sizeof(T));
+        }
+        /// truncates the file to the current length
+        auto shrink_to_fit() -> void {
+            file.resize(header::DATA_OFFSET + std::max<usize>(size(), 1) * sizeof(T));
+        }
+        /// synchronously writes all changes to disk, they reach the file eventually even without it
+        auto flush() -> void { file.flush(); }
+        auto advise(const core::access_hint hint) const noexcept -> void {
+            file.advise(hint, header::DATA_OFFSET, size() * sizeof(T));
+        }
+
+        [[nodiscard]] auto as_span() noexcept -> std::span<T> { return {data(), size()}; }
+        [[nodiscard]] auto as_span() const noexcept -> std::span<const T> { return {data(), size()}; }
+        [[nodiscard]] auto begin() noexcept -> T* { return data(); }
+        [[nodiscard]] auto end() noexcept -> T* { return data() + size(); }
+        [[nodiscard]] auto begin() const noexcept -> const T* { return data(); }
+        [[nodiscard]] auto end() const noexcept -> const T* { return data() + size(); }
+
+        auto format_to(format::sink& out) const -> void override {
+            const usize len = size();
+            out.put('[');
+            for (usize i = 0; i < len; i++) {
+                if (i != 0) out.write(", ");
+                format::format_to(out, data()[i]);
+            }
+            out.put(']');
+        }
+        auto print(std::ostream& os) const -> void override {
+            format::ostream_sink out(os);
+            format_to(out);
+        }
+
+    private:
+        core::mapped_file file;
+
+        [[nodiscard]] auto hdr() const noexcept -> header* { return reinterpret_cast<header*>(file.data()); }
+        [[nodiscard]] auto data() const noexcept -> T* { return reinterpret_cast<T*>(file.data() + header::DATA_OFFSET); }
+        /// element index of `p`, `size()` when it does not point into the live elements
+        [[nodiscard]] auto index_of(const T* p) const noexcept -> usize {
+            const std::less<const T*> before;
+            const usize len = size();
+            if (before(p, data()) || !before(p, data() + len)) return len;
+            return static_cast<usize>(p - data());
+        }
+    };
+}
@@ -0,0 +1,349 @@
+#pragma once
+
+#include <orc_export.hpp>
+#include <ordefs.hpp>
+#include <checks.hpp>
+#include <container.hpp>
+#include <atomic>
+#include <memory>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "instrument.hpp"
+#include "iterator.hpp"
+
+using namespace orc::core::container;
+using namespace orc::core::defines;
+using namespace orc::iterators;
+
+namespace orc::containers {
+
+    /// trie node, branches hold up to 32 children and leaves up to 32 values.
+    /// `owner` is the token of the transient allowed to change it in place, 0 for nodes built by persistent updates
+    template<typename T, class Alloc>
+    struct ORC_API _pvec_node {
+        std::vector<std::shared_ptr<_pvec_node>> children;
+        std::vector<T, Alloc> values;
+        u64 owner = 0;
+    };
+
+    template<typename T, class Alloc>
+    class ORC_API transient_vector;
+
+    /// persistent vector: a 32-way trie plus a tail leaf. copies share everything, `push`, `set` and `pop`
+    /// return a new version which copies only the O(log32 n) nodes on one path. versions are immutable
+    /// and can be read from any thread, batches of updates go through `transient`
+    template<typename T, class Alloc = std::allocator<T>>
+    class ORC_API persistent_vector : public container<T, Alloc> {
+    public:
+        static constexpr u32 BITS = 5;
+        static constexpr usize WIDTH = usize{1} << BITS;
+        static constexpr usize MASK = WIDTH - 1;
+
+        persistent_vector() = default;
+        persistent_vector(std::initializer_list<T> init) {
+            auto batch = transient();
+            for (const auto& value : init) batch.push(value);
+            *this = batch.persistent();
+        }
+        persistent_vector(const persistent_vector&) = default;
+        persistent_vector(persistent_vector&&) noexcept = default;
+        auto operator=(const persistent_vector&) -> persistent_vector& = default;
+        auto operator=(persistent_vector&&) noexcept -> persistent_vector& = default;
+        ~persistent_vector() override = default;
+
+        [[nodiscard]] auto size() const noexcept -> usize override { return count; }
+        [[nodiscard]] auto is_empty() const noexcept -> bool override { return count == 0; }
+        [[nodiscard]] auto get(const usize idx) const -> const T& override {
+            ORC_BOUNDS_CHECK(idx < count, "index out of range");
+            return leaf_for(idx)->values[idx & MASK];
+        }
+        [[nodiscard]] auto operator[](const usize idx) const -> const T& override { return get(idx); }
+        [[nodiscard]] auto get_unchecked(const usize idx) const -> const T& {
+            ORC_DEBUG_CHECK(idx < count, "index out of range");
+            return leaf_for(idx)->values[idx & MASK];
+        }
+        [[nodiscard]] auto back() const -> const T& {
+            if (count == 0) [[unlikely]] core::checks::_fail_out_of_range("empty vector");
+            return tail->values.back();
+        }
+
+        /// new version with `value` appended
+        [[nodiscard]] auto push(const T& value) const -> persistent_vector {
+            persistent_vector out(*this);
+            out.push_in_place(value, 0);
+            return out;
+        }
+        /// new version with element `idx` replaced
+        [[nodiscard]] auto set(const usize idx, const T& value) const -> persistent_vector {
+            persistent_vector out(*this);
+            out.set_in_place(idx, value, 0);
+            return out;
+        }
+        /// new version without the last element
+        [[nodiscard]] auto pop() const -> persistent_vector {
+            persistent_vector out(*this);
+            out.pop_in_place(0);
+            return out;
+        }
+        /// mutable copy for batch updates, changes nodes it created in place instead of copying them again
+        [[nodiscard]] auto transient() const -> transient_vector<T, Alloc> { return transient_vector<T, Alloc>(*this); }
+
+        /// calls `f(std::span<const T>)` for every leaf in order
+        template<typename F>
+        auto for_each_chunk(F&& f) const -> void {
+            for (usize at = 0; at < count; at += WIDTH) {
+                const auto& values = leaf_for(at)->values;
+                f(std::span<const T>(values.data(), values.size()));
+            }
+        }
+
+        auto format_to(format::sink& out) const -> void override {
+            out.put('[');
+            bool first = true;
+            for_each_chunk([&out, &first](const std::span<const T> chunk) {
+                for (const auto& value : chunk) {
+                    if (!first) out.write(", ");
+                    first = false;
+                    format::format_to(out, value);
+                }
+            });
+            out.put(']');
+        }
+        auto print(std::ostream& os) const -> void override {
+            format::ostream_sink out(os);
+            format_to(out);
+        }
+
+        [[nodiscard]] static auto from_iter(std::unique_ptr<iterator<T>> iter) -> persistent_vector {
+            auto batch = persistent_vector().transient();
+            foreach(i, (*iter), {
+                batch.push(i);
+            })
+            return batch.persistent();
+        }
+
+    private:
+        friend class transient_vector<T, Alloc>;
+        using node = _pvec_node<T, Alloc>;
+        using node_ptr = std::shared_ptr<node>;
+
+        usize count = 0;
+        u32 shift = BITS;
+        node_ptr root;
+        node_ptr tail;
+
+        /// first index stored in the tail
+        [[nodiscard]] auto tail_offset() const noexcept -> usize { return count < WIDTH ? 0 : (count - 1) & ~MASK; }
+
+        [[nodiscard]] auto leaf_for(const usize idx) const noexcept -> const node* {
+            if (idx >= tail_offset()) return tail.get();
+            const node* at = root.get();
+            for (u32 level = shift; level > 0; level -= BITS) at = at->children[(idx >> level) & MASK].get();
+            return at;
+        }
+
+        [[nodiscard]] static auto fresh(const u64 edit) -> node_ptr {
+            ORC_RECORD(persistent_vector, Allocation, 1);
+            auto out = std::make_shared<node>();
+            out->owner = edit;
+            return out;
+        }
+        /// `src` itself when owned by `edit`, otherwise a copy owned by it
+        [[nodiscard]] static auto editable(const node_ptr& src, const u64 edit) -> node_ptr {
+            if (edit != 0 && src->owner == edit) return src;
+            ORC_RECORD(persistent_vector, Allocation, 1);
+            ORC_RECORD(persistent_vector, BytesCopied, src->children.size() * sizeof(node_ptr) + src->values.size() * sizeof(T));
+            auto out = std::make_shared<node>();
+            // reserved up front, an owned node is usually filled further in place
+            if (!src->children.empty()) {
+                out->children.reserve(WIDTH);
+                out->children = src->children;
+            } else {
+                out->values.reserve(WIDTH);
+                out->values = src->values;
+            }
+            out->owner = edit;
+            return out;
+        }
+        [[nodiscard]] static auto new_path(const u32 level, node_ptr leaf, const u64 edit) -> node_ptr {
+            if (level == 0) return leaf;
+            auto out = fresh(edit);
+            out->children.push_back(new_path(level - BITS, std::move(leaf), edit));
+            return out;
+        }
+        /// `parent` with the full tail hung at index `count - 1`
+        [[nodiscard]] auto push_tail(const u32 level, const node_ptr& parent, node_ptr leaf, const u64 edit) const -> node_ptr {
+            const usize sub = ((count - 1) >> level) & MASK;
+            node_ptr out = parent ? editable(parent, edit) : fresh(edit);
+            node_ptr insert;
+            if (level == BITS) insert = std::move(leaf);
+            else if (sub < out->children.size()) insert = push_tail(level - BITS, out->children[sub], std::move(leaf), edit);
+            else insert = new_path(level - BITS, std::move(leaf), edit);
+            if (sub < out->children.size()) out->children[sub] = std::move(insert);
+            else out->children.push_back(std::move(insert));
+            return out;
+        }
+        /// `parent` without the leaf holding index `count - 2`, null when nothing is left
+        [[nodiscard]] auto pop_tail(const u32 level, const node_ptr& parent, const u64 edit) const -> node_ptr {
+            const usize sub = ((count - 2) >> level) & MASK;
+            if (level > BITS) {
+                node_ptr child = pop_tail(level - BITS, parent->children[sub], edit);
+                if (child == nullptr && sub == 0) return nullptr;
+                node_ptr out = editable(parent, edit);
+                if (child == nullptr) out->children.pop_back();
+                else out->children[sub] = std::move(child);
+                return out;
+            }
+            if (sub == 0) return nullptr;
+            node_ptr out = editable(parent, edit);
+            out->children.pop_back();
+            return out;
+        }
+        [[nodiscard]] static auto assoc(const u32 level, const node_ptr& parent, const usize idx, const T& value, const u64 edit) -> node_ptr {
+            node_ptr out = editable(parent, edit);
+            if (level == 0) out->values[idx & MASK] = value;
+            else {
+                const usize sub = (idx >> level) & MASK;
+                out->children[sub] = assoc(level - BITS, out->children[sub], idx, value, edit);
+            }
+            return out;
+        }
+
+        auto push_in_place(const T& value, const u64 edit) -> void {
+            if (count - tail_offset() < WIDTH) {
+                if (tail == nullptr) {
+                    tail = fresh(edit);
+                    tail->values.reserve(WIDTH);
+                } else if (edit == 0 || tail->owner != edit) tail = editable(tail, edit);
+            } else {
+                if ((count >> BITS) > (usize{1} << shift)) {
+                    // the trie is full, grow a level
+                    auto grown = fresh(edit);
+                    grown->children.push_back(std::move(root));
+                    grown->children.push_back(new_path(shift, std::move(tail), edit));
+                    root = std::move(grown);
+                    shift += BITS;
+                } else root = push_tail(shift, root, std::move(tail), edit);
+                tail = fresh(edit);
+                tail->values.reserve(WIDTH);
+            }
+            tail->values.push_back(value);
+            count++;
+            ORC_RECORD(persistent_vector, Construction, 1);
+        }
+        auto set_in_place(const usize idx, const T& value, const u64 edit) -> void {
+            ORC_BOUNDS_CHECK(idx < count, "index out of range");
+            if (idx >= tail_offset()) {
+                tail = editable(tail, edit);
+                tail->values[idx & MASK] = value;
+            } else root = assoc(shift, root, idx, value, edit);
+        }
+        auto pop_in_place(const u64 edit) -> void {
+            if (count == 0) [[unlikely]] core::checks::_fail_out_of_range("empty vector");
+            if (count == 1) {
+                *this = persistent_vector();
+                return;
+            }
+            if (count - tail_offset() > 1) {
+                tail = editable(tail, edit);
+                tail->values.pop_back();
+                count--;
+                return;
+            }
+            node_ptr leaf = root;
+            for (u32 level = shift; level > 0; level -= BITS) leaf = leaf->children[((count - 2) >> level) & MASK];
+            node_ptr trimmed = pop_tail(shift, root, edit);
+            if (shift > BITS && trimmed != nullptr && trimmed->children.size() == 1) {
+                // the root has a single child left, drop a level
+                trimmed = trimmed->children[0];
+                shift -= BITS;
+            }
+            root = std::move(trimmed);
+            tail = std::move(leaf);
+            count--;
+        }
+    };
+
+    /// source of owner tokens, never handed out twice so a finished transient can't touch shared nodes
+    inline std::atomic<u64> _pvec_edits{1};
+
+    /// batch builder over a `persistent_vector`. nodes copied once by a transient are owned by it and changed
+    /// in place afterwards, so n pushes cost amortized O(1) each instead of a path copy each.
+    /// not thread-safe, and unusable after `persistent`
+    template<typename T, class Alloc>
+    class ORC_API transient_vector {
+    public:
+        explicit transient_vector(persistent_vector<T, Alloc> base) : vec(std::move(base)), edit(_pvec_edits.fetch_add(1, std::memory_order_relaxed)) {}
+        // a copy would share the owner token and write into the nodes of the original
+        transient_vector(const transient_vector&) = delete;
+        auto operator=(const transient_vector&) -> transient_vector& = delete;
+        transient_vector(transient_vector&& other) noexcept : vec(std::move(other.vec)), edit(std::exchange(other.edit, 0)) {}
+        auto operator=(transient_vector&& other) noexcept -> transient_vector& {
+            vec = std::move(other.vec);
+            edit = std::exchange(other.edit, 0);
+            return *this;
+        }
+
+        [[nodiscard]] auto size() const noexcept -> usize { return vec.size(); }
+        [[nodiscard]] auto is_empty() const noexcept -> bool { return vec.is_empty(); }
+        [[nodiscard]] auto get(const usize idx) const -> const T& { return vec.get(idx); }
+        [[nodiscard]] auto operator[](const usize idx) const -> const T& { return vec.get(idx); }
+
+        auto push(const T& value) -> transient_vector& {
+            vec.push_in_place(value, alive());
+            return *this;
+        }
+        auto set(const usize idx, const T& value) -> transient_vector& {
+            vec.set_in_place(idx, value, alive());
+            return *this;
+        }
+        [[nodiscard]] auto pop() -> T {
+            const u64 token = alive();
+            T out = vec.back();
+            vec.pop_in_place(token);
+            return out;
+        }
+
+        /// freezes the result, the transient can't be changed afterwards
+        [[nodiscard]] auto persistent() -> persistent_vector<T, Alloc> {
+            (void)alive();
+            edit = 0;
+            return std::move(vec);
+        }
+
+    private:
+        persistent_vector<T, Alloc> vec;
+        u64 edit;
+
+        [[nodiscard]] auto alive() const -> u64 {
+            if (edit == 0) throw std::logic_error("transient used after persistent()");
+            return edit;
+        }
+    };
+
+    template<typename T, class Alloc = std::allocator<T>>
+    class ORC_API persistent_vector_iterator final : public iterator<T> {
+    public:
+        explicit persistent_vector_iterator(persistent_vector<T, Alloc> vec) : vec(std::move(vec)) {}
+        auto clone() const -> std::unique_ptr<iterator<T>> override {
+            ORC_RECORD(persistent_vector_iterator, IteratorClone, 1);
+            return std::make_unique<persistent_vector_iterator>(*this);
+        }
+        [[nodiscard]] auto has_next() const noexcept -> bool override { return pos < vec.size(); }
+        [[nodiscard]] auto next() -> T override {
+            if (!has_next()) _end_iteration<persistent_vector_iterator>();
+            return vec.get(pos++);
+        }
+        [[nodiscard]] auto try_next() -> orc::optional::optional<T> override {
+            if (!has_next()) return orc::optional::none;
+            return orc::optional::some(vec.get(pos++));
+        }
+    private:
+        // holds its own version, so the iterator stays valid whatever happens to the source
+        persistent_vector<T, Alloc> vec;
+        usize pos = 0;
+    };
+}
@@ -0,0 +1,287 @@
+#pragma once
+
+#include <orc_export.hpp>
+#include <ordefs.hpp>
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "divisor.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ORC_SWISS_SSE2
+#endif
+
+using namespace orc::core::defines;
+
+namespace orc::containers {
+
+    /// control bytes: `Empty` and `Deleted` have the top bit set, full slots store the low 7 hash bits
+    enum class ORC_API _ctrl : i8 {
+        Empty = -128,
+        Deleted = -2,
+    };
+
+    /// 16 control bytes probed at once
+    struct ORC_API _group {
+        static constexpr usize WIDTH = 16;
+
+        [[nodiscard]] static auto match(const i8* ctrl, const i8 h2) noexcept -> u32 {
+#ifdef ORC_SWISS_SSE2
+            const __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+            return static_cast<u32>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), group)));
+#else
+            u32 mask = 0;
+            for (usize i = 0; i < WIDTH; ++i) mask |= static_cast<u32>(ctrl[i] == h2) << i;
+            return mask;
+#endif
+        }
+        [[nodiscard]] static auto match_empty(const i8* ctrl) noexcept -> u32 {
+            return match(ctrl, static_cast<i8>(_ctrl::Empty));
+        }
+        [[nodiscard]] static auto match_free(const i8* ctrl) noexcept -> u32 {
+#ifdef ORC_SWISS_SSE2
+            // every non-full byte has its top bit set
+            const __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+            return static_cast<u32>(_mm_movemask_epi8(group));
+#else
+            u32 mask = 0;
+            for (usize i = 0; i < WIDTH; ++i) mask |= static_cast<u32>(ctrl[i] < 0) << i;
+            return mask;
+#endif
+        }
+    };
+
+    alignas(16) inline constexpr i8 _EMPTY_GROUP[_group::WIDTH] = {
+        -128, -128, -128, -128, -128, -128, -128, -128,
+        -128, -128, -128, -128, -128, -128, -128, -128,
+    };
+
+    /// spreads weak hashes (identity `std::hash` of integers) over all bits
+    [[nodiscard]] constexpr auto _mix_hash(const u64 h) noexcept -> u64 {
+        constexpr u64 K = 0x9E3779B97F4A7C15ull;
+        return utils::arithmetic::mul_high(h, K) ^ (h * K);
+    }
+
+    template<typename H, typename E>
+    concept _transparent = requires { typename H::is_transparent; typename E::is_transparent; };
+
+    /// lookup keys: anything convertible to `Key`, or any type at all with transparent `Hash` and `Eq`
+    template<typename Q, typename Key, typename H, typename E>
+    concept _key_arg = std::convertible_to<const Q&, const Key&> || _transparent<H, E>;
+
+    /// open-addressing table shared by `flat_hash_map` and `flat_hash_set`.
+    /// `KeyOf` extracts the key from a stored slot
+    template<typename Key, typename Slot, typename KeyOf, typename Hash, typename Eq, class Alloc>
+    class ORC_API _raw_hash_table {
+    public:
+        using slot_alloc = typename std::allocator_traits<Alloc>::template rebind_alloc<Slot>;
+        using ctrl_alloc = typename std::allocator_traits<Alloc>::template rebind_alloc<i8>;
+        using slot_traits = std::allocator_traits<slot_alloc>;
+        using ctrl_traits = std::allocator_traits<ctrl_alloc>;
+        static constexpr usize npos = static_cast<usize>(-1);
+
+        _raw_hash_table() = default;
+        _raw_hash_table(const _raw_hash_table& other) : hasher(other.hasher), eq(other.eq), slots_alloc(other.slots_alloc), ctrls_alloc(other.ctrls_alloc) {
+            reserve(other.len);
+            try {
+                for (usize i = 0; i < other.cap; ++i)
+                    if (other.ctrl[i] >= 0) emplace_unique(other.hash_of(KeyOf{}(other.slots[i])), other.slots[i]);
+            } catch (...) {
+                // the destructor doesn't run for a constructor that throws
+                release();
+                throw;
+            }
+        }
+        _raw_hash_table(_raw_hash_table&& other) noexcept
+            : ctrl(other.ctrl), slots(other.slots), cap(other.cap), len(other.len), growth_left(other.growth_left),
+              hasher(std::move(other.hasher)), eq(std::move(other.eq)),
+              slots_alloc(std::move(other.slots_alloc)), ctrls_alloc(std::move(other.ctrls_alloc)) {
+            other.reset_empty();
+        }
+        auto operator=(_raw_hash_table other) noexcept -> _raw_hash_table& {
+            swap(*this, other);
+            return *this;
+        }
+        friend auto swap(_raw_hash_table& lhs, _raw_hash_table& rhs) noexcept -> void {
+            std::swap(lhs.ctrl, rhs.ctrl);
+            std::swap(lhs.slots, rhs.slots);
+            std::swap(lhs.cap, rhs.cap);
+            std::swap(lhs.len, rhs.len);
+            std::swap(lhs.growth_left, rhs.growth_left);
+            std::swap(lhs.hasher, rhs.hasher);
+            std::swap(lhs.eq, rhs.eq);
+            std::swap(lhs.slots_alloc, rhs.slots_alloc);
+            std::swap(lhs.ctrls_alloc, rhs.ctrls_alloc);
+        }
+        ~_raw_hash_table() { release(); }
+
+        [[nodiscard]] constexpr auto size() const noexcept -> usize { return len; }
+        [[nodiscard]] constexpr auto is_empty() const noexcept -> bool { return len == 0; }
+        [[nodiscard]] constexpr auto capacity() const noexcept -> usize { return cap; }
+        [[nodiscard]] constexpr auto slot_count() const noexcept -> usize { return cap; }
+        [[nodiscard]] constexpr auto is_full(const usize idx) const noexcept -> bool { return ctrl[idx] >= 0; }
+        [[nodiscard]] constexpr auto slot(const usize idx) noexcept -> Slot& { return slots[idx]; }
+        [[nodiscard]] constexpr auto slot(const usize idx) const noexcept -> const Slot& { return slots[idx]; }
+
+        template<typename Q>
+        [[nodiscard]] auto hash_of(const Q& key) const -> u64 {
+            return _mix_hash(static_cast<u64>(hasher(key)));
+        }
+
+        /// index of the slot holding `key`, or `npos`
+        template<typename Q>
+        [[nodiscard]] auto find_index(const Q& key, const u64 hash) const -> usize {
+            const usize groups_mask = group_count() - 1;
+            const i8 h2 = static_cast<i8>(hash & 0x7F);
+            usize g = static_cast<usize>(hash >> 7) & groups_mask;
+            for (usize step = 1;; ++step) {
+                const i8* group = ctrl + g * _group::WIDTH;
+                for (u32 m = _group::match(group, h2); m != 0; m &= m - 1) {
+                    const usize idx = g * _group::WIDTH + static_cast<usize>(std::countr_zero(m));
+                    if (eq(KeyOf{}(slots[idx]), key)) [[likely]] return idx;
+                }
+                if (_group::match_empty(group) != 0) [[likely]] return npos;
+                g = (g + step) & groups_mask;
+            }
+        }
+        template<typename Q>
+        [[nodiscard]] auto find_index(const Q& key) const -> usize { return find_index(key, hash_of(key)); }
+
+        /// constructs a slot for a key known to be absent, returns its index
+        template<typename... Args>
+        auto emplace_unique(const u64 hash, Args&&... args) -> usize {
+            if (growth_left == 0) [[unlikely]] grow();
+            usize idx = find_free(hash);
+            slot_traits::construct(slots_alloc, slots + idx, std::forward<Args>(args)...);
+            if (ctrl[idx] == static_cast<i8>(_ctrl::Empty)) growth_left--;
+            ctrl[idx] = static_cast<i8>(hash & 0x7F);
+            len++;
+            return idx;
+        }
+
+        auto erase_index(const usize idx) -> void {
+            slot_traits::destroy(slots_alloc, slots + idx);
+            // a slot in a group that never filled up can become empty again, since no probe continued past it
+            const usize group_start = idx & ~(_group::WIDTH - 1);
+            if (_group::match_empty(ctrl + group_start) != 0) {
+                ctrl[idx] = static_cast<i8>(_ctrl::Empty);
+                growth_left++;
+            } else {
+                ctrl[idx] = static_cast<i8>(_ctrl::Deleted);
+            }
+            len--;
+        }
+
+        auto clear() -> void {
+            for (usize i = 0; i < cap; ++i) {
+                if (ctrl[i] >= 0) slot_traits::destroy(slots_alloc, slots + i);
+                ctrl[i] = static_cast<i8>(_ctrl::Empty);
+            }
+            len = 0;
+            growth_left = max_load(cap);
+        }
+
+        /// makes room for `n` elements without further rehashing
+        auto reserve(const usize n) -> void {
+            if (n > len + growth_left) rehash(n);
+        }
+        /// rebuilds the table with enough slots for `max(n, size())` elements
+        auto rehash(const usize n) -> void {
+            const usize target = std::max<usize>(n, len);
+            usize new_cap = 0;
+            if (target != 0) {
+                new_cap = _group::WIDTH;
+                while (max_load(new_cap) < target) new_cap *= 2;
+            }
+            resize(new_cap);
+        }
+
+    private:
+        i8* ctrl = const_cast<i8*>(_EMPTY_GROUP);
+        Slot* slots = nullptr;
+        usize cap = 0;
+        usize len = 0;
+        usize growth_left = 0;
+        [[no_unique_address]] Hash hasher;
+        [[no_unique_address]] Eq eq;
+        slot_alloc slots_alloc;
+        ctrl_alloc ctrls_alloc;
+
+        [[nodiscard]] static constexpr auto max_load(const usize slots) noexcept -> usize { return slots - slots / 8; }
+        [[nodiscard]] constexpr auto group_count() const noexcept -> usize { return cap == 0 ? 1 : cap / _group::WIDTH; }
+
+        [[nodiscard]] auto find_free(const u64 hash) const noexcept -> usize {
+            const usize groups_mask = group_count() - 1;
+            usize g = static_cast<usize>(hash >> 7) & groups_mask;
+            for (usize step = 1;; ++step) {
+                if (const u32 m = _group::match_free(ctrl + g * _group::WIDTH); m != 0) [[likely]]
+                    return g * _group::WIDTH + static_cast<usize>(std::countr_zero(m));
+                g = (g + step) & groups_mask;
+            }
+        }
+
+        auto grow() -> void {
+            // tables full of tombstones are cleaned up in place instead of doubling
+            if (cap != 0 && len < max_load(cap) / 2) resize(cap);
+            else resize(cap == 0 ? _group::WIDTH : cap * 2);
+        }
+
+        auto resize(const usize new_cap) -> void {
+            i8* old_ctrl = ctrl;
+            Slot* old_slots = slots;
+            const usize old_cap = cap;
+            if (new_cap == 0) {
+                reset_empty();
+            } else {
+                ctrl = ctrl_traits::allocate(ctrls_alloc, new_cap);
+                try {
+                    slots = slot_traits::allocate(slots_alloc, new_cap);
+                } catch (...) {
+                    ctrl_traits::deallocate(ctrls_alloc, ctrl, new_cap);
+                    ctrl = old_ctrl;
+                    throw;
+                }
+                std::fill(ctrl, ctrl + new_cap, static_cast<i8>(_ctrl::Empty));
+                cap = new_cap;
+                growth_left = max_load(new_cap);
+            }
+            len = 0;
+            for (usize i = 0; i < old_cap; ++i) {
+                if (old_ctrl[i] < 0) continue;
+                const u64 h = hash_of(KeyOf{}(old_slots[i]));
+                const usize idx = find_free(h);
+                slot_traits::construct(slots_alloc, slots + idx, std::move(old_slots[i]));
+                slot_traits::destroy(slots_alloc, old_slots + i);
+                ctrl[idx] = static_cast<i8>(h & 0x7F);
+                growth_left--;
+                len++;
+            }
+            if (old_cap != 0) {
+                ctrl_traits::deallocate(ctrls_alloc, old_ctrl, old_cap);
+                slot_traits::deallocate(slots_alloc, old_slots, old_cap);
+            }
+        }
+
+        auto release() -> void {
+            if (cap == 0) return;
+            for (usize i = 0; i < cap; ++i)
+                if (ctrl[i] >= 0) slot_traits::destroy(slots_alloc, slots + i);
+            ctrl_traits::deallocate(ctrls_alloc, ctrl, cap);
+            slot_traits::deallocate(slots_alloc, slots, cap);
+            reset_empty();
+        }
+        auto reset_empty() noexcept -> void {
+            ctrl = const_cast<i8*>(_EMPTY_GROUP);
+            slots = nullptr;
+            cap = 0;
+            len = 0;
+            growth_left = 0;
+        }
+    };
+}
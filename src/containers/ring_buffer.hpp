@@ -0,0 +1,160 @@
+#pragma once
+
+#include <orc_export.hpp>
+#include <ordefs.hpp>
+#include <checks.hpp>
+#include <container.hpp>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+#include "optional.hpp"
+
+using namespace orc::core::container;
+using namespace orc::core::defines;
+
+namespace orc::containers {
+
+    /// fixed-capacity fifo queue with inline storage, never allocates.
+    /// indices passed to `get`/`set` count from the front
+    template<typename T, usize N>
+    class ORC_API ring_buffer final : public queue_container<T> {
+        static_assert(N > 0, "ring buffer capacity must be positive");
+    public:
+        ring_buffer() = default;
+        ring_buffer(std::initializer_list<T> init) {
+            for (const auto& t : init) push(t);
+        }
+        ring_buffer(const ring_buffer& other) {
+            for (usize i = 0; i < other.len; ++i) push(other[i]);
+        }
+        ring_buffer(ring_buffer&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+            for (usize i = 0; i < other.len; ++i) emplace(std::move(other[i]));
+            other.clear();
+        }
+        auto operator=(const ring_buffer& other) -> ring_buffer& {
+            if (this == &other) return *this;
+            clear();
+            for (usize i = 0; i < other.len; ++i) push(other[i]);
+            return *this;
+        }
+        auto operator=(ring_buffer&& other) noexcept(std::is_nothrow_move_constructible_v<T>) -> ring_buffer& {
+            if (this == &other) return *this;
+            clear();
+            for (usize i = 0; i < other.len; ++i) emplace(std::move(other[i]));
+            other.clear();
+            return *this;
+        }
+        ~ring_buffer() override { clear(); }
+
+        [[nodiscard]] constexpr auto size() const noexcept -> usize override { return len; }
+        [[nodiscard]] constexpr auto is_empty() const noexcept -> bool override { return len == 0; }
+        [[nodiscard]] constexpr auto is_full() const noexcept -> bool { return len == N; }
+        [[nodiscard]] static constexpr auto capacity() noexcept -> usize { return N; }
+
+        [[nodiscard]] auto get(const usize idx) const -> const T& override {
+            ORC_BOUNDS_CHECK(idx < len, "index out of range");
+            return *slot(wrap(head + idx));
+        }
+        [[nodiscard]] auto get(const usize idx) -> T& override {
+            ORC_BOUNDS_CHECK(idx < len, "index out of range");
+            return *slot(wrap(head + idx));
+        }
+        [[nodiscard]] auto operator[](const usize idx) const -> const T& override { return get(idx); }
+        [[nodiscard]] auto operator[](const usize idx) -> T& override { return get(idx); }
+        [[nodiscard]] auto get_unchecked(const usize idx) const -> const T& {
+            ORC_DEBUG_CHECK(idx < len, "index out of range");
+            return *slot(wrap(head + idx));
+        }
+        [[nodiscard]] auto get_unchecked(const usize idx) -> T& {
+            ORC_DEBUG_CHECK(idx < len, "index out of range");
+            return *slot(wrap(head + idx));
+        }
+        auto set(const usize idx, const T& value) -> void override { get(idx) = value; }
+
+        [[nodiscard]] auto front() const -> const T& override {
+            if (len == 0) [[unlikely]] core::checks::_fail_out_of_range("empty ring buffer");
+            return *slot(head);
+        }
+        [[nodiscard]] auto front() -> T& override {
+            if (len == 0) [[unlikely]] core::checks::_fail_out_of_range("empty ring buffer");
+            return *slot(head);
+        }
+        [[nodiscard]] auto back() const -> const T& {
+            if (len == 0) [[unlikely]] core::checks::_fail_out_of_range("empty ring buffer");
+            return *slot(wrap(head + len - 1));
+        }
+
+        auto push(const T& value) -> void override {
+            if (len == N) [[unlikely]] core::checks::_fail_out_of_range("ring buffer is full");
+            emplace(value);
+        }
+        [[nodiscard]] auto pop() -> T override {
+            if (len == 0) [[unlikely]] core::checks::_fail_out_of_range("empty ring buffer");
+            return take_front();
+        }
+        /// returns false instead of throwing when full
+        auto try_push(T value) -> bool {
+            if (len == N) return false;
+            emplace(std::move(value));
+            return true;
+        }
+        [[nodiscard]] auto try_pop() -> orc::optional::optional<T> {
+            if (len == 0) return orc::optional::none;
+            return orc::optional::some(take_front());
+        }
+        /// overwrites the oldest element when full
+        auto push_overwrite(T value) -> void {
+            if (len == N) {
+                std::destroy_at(slot(head));
+                head = wrap(head + 1);
+                len--;
+            }
+            emplace(std::move(value));
+        }
+
+        auto clear() noexcept -> void {
+            for (usize i = 0; i < len; ++i) std::destroy_at(slot(wrap(head + i)));
+            head = 0;
+            len = 0;
+        }
+
+        auto format_to(format::sink& out) const -> void override {
+            out.put('[');
+            for (usize i = 0; i < len; i++) {
+                if (i != 0) out.write(", ");
+                format::format_to(out, *slot(wrap(head + i)));
+            }
+            out.put(']');
+        }
+        auto print(std::ostream& os) const -> void override {
+            format::ostream_sink out(os);
+            format_to(out);
+        }
+
+    private:
+        alignas(T) std::byte storage[sizeof(T) * N];
+        usize head = 0;
+        usize len = 0;
+
+        [[nodiscard]] static constexpr auto wrap(const usize idx) noexcept -> usize { return idx >= N ? idx - N : idx; }
+        [[nodiscard]] auto slot(const usize idx) noexcept -> T* { return std::launder(reinterpret_cast<T*>(storage) + idx); }
+        [[nodiscard]] auto slot(const usize idx) const noexcept -> const T* { return std::launder(reinterpret_cast<const T*>(storage) + idx); }
+
+        template<typename... Args>
+        auto emplace(Args&&... args) -> void {
+            std::construct_at(reinterpret_cast<T*>(storage) + wrap(head + len), std::forward<Args>(args)...);
+            len++;
+        }
+        auto take_front() -> T {
+            T* p = slot(head);
+            T tmp = std::move(*p);
+            std::destroy_at(p);
+            head = wrap(head + 1);
+            len--;
+            return tmp;
+        }
+    };
+}
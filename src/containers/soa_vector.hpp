@@ -0,0 +1,325 @@
+#pragma once
+
+#include <orc_export.hpp>
+#include <ordefs.hpp>
+#include <checks.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "format.hpp"
+#include "iterator.hpp"
+
+using namespace orc::core::defines;
+using namespace orc::iterators;
+
+namespace orc::containers {
+
+    /// structure-of-arrays vector: every field of the record lives in its own contiguous column.
+    /// rows are exposed as tuples of references, columns as spans
+    template<class Alloc, typename... Fields>
+    class ORC_API basic_soa_vector {
+        static_assert(sizeof...(Fields) > 0, "soa_vector needs at least one field");
+        template<usize I>
+        using field_t = std::tuple_element_t<I, std::tuple<Fields...>>;
+        template<typename T>
+        using alloc_t = typename std::allocator_traits<Alloc>::template rebind_alloc<T>;
+        template<typename T>
+        using traits_t = std::allocator_traits<alloc_t<T>>;
+        using indices = std::make_integer_sequence<usize, sizeof...(Fields)>;
+    public:
+        using value_type = std::tuple<Fields...>;
+        using reference = std::tuple<Fields&...>;
+        using const_reference = std::tuple<const Fields&...>;
+
+        template<bool Const>
+        class basic_iterator {
+        public:
+            using owner_ptr = std::conditional_t<Const, const basic_soa_vector*, basic_soa_vector*>;
+            using value_type = basic_soa_vector::value_type;
+            using reference = std::conditional_t<Const, const_reference, basic_soa_vector::reference>;
+            using difference_type = isize;
+
+            basic_iterator() = default;
+            basic_iterator(owner_ptr owner, const usize idx) : owner(owner), idx(idx) {}
+            [[nodiscard]] auto operator*() const -> reference { return owner->row(idx); }
+            [[nodiscard]] auto operator[](const difference_type n) const -> reference { return owner->row(idx + n); }
+            auto operator++() -> basic_iterator& { ++idx; return *this; }
+            auto operator++(int) -> basic_iterator { auto tmp = *this; ++idx; return tmp; }
+            auto operator--() -> basic_iterator& { --idx; return *this; }
+            auto operator--(int) -> basic_iterator { auto tmp = *this; --idx; return tmp; }
+            auto operator+=(const difference_type n) -> basic_iterator& { idx += n; return *this; }
+            auto operator-=(const difference_type n) -> basic_iterator& { idx -= n; return *this; }
+            [[nodiscard]] auto operator+(const difference_type n) const -> basic_iterator { return {owner, idx + n}; }
+            [[nodiscard]] auto operator-(const difference_type n) const -> basic_iterator { return {owner, idx - n}; }
+            [[nodiscard]] auto operator-(const basic_iterator& other) const -> difference_type {
+                return static_cast<difference_type>(idx) - static_cast<difference_type>(other.idx);
+            }
+            [[nodiscard]] auto operator==(const basic_iterator& other) const noexcept -> bool { return idx == other.idx; }
+            [[nodiscard]] auto operator<=>(const basic_iterator& other) const noexcept { return idx <=> other.idx; }
+        private:
+            owner_ptr owner = nullptr;
+            usize idx = 0;
+        };
+        using iterator = basic_iterator<false>;
+        using const_iterator = basic_iterator<true>;
+
+        basic_soa_vector() = default;
+        explicit basic_soa_vector(const usize initial_cap) { reallocate(initial_cap); }
+        basic_soa_vector(std::initializer_list<value_type> init) {
+            reallocate(init.size());
+            try {
+                for (const auto& row : init) push(row);
+            } catch (...) {
+                destroy();
+                throw;
+            }
+        }
+        basic_soa_vector(const basic_soa_vector& other) : allocator(other.allocator) {
+            reallocate(other.len);
+            try {
+                for (usize i = 0; i < other.len; ++i) push(other.get(i));
+            } catch (...) {
+                // the destructor doesn't run for a constructor that throws
+                destroy();
+                throw;
+            }
+        }
+        basic_soa_vector(basic_soa_vector&& other) noexcept
+            : columns(std::exchange(other.columns, {})), len(std::exchange(other.len, 0)),
+              cap(std::exchange(other.cap, 0)), allocator(std::move(other.allocator)) {}
+        auto operator=(basic_soa_vector other) noexcept -> basic_soa_vector& {
+            std::swap(columns, other.columns);
+            std::swap(len, other.len);
+            std::swap(cap, other.cap);
+            std::swap(allocator, other.allocator);
+            return *this;
+        }
+        ~basic_soa_vector() { destroy(); }
+
+        [[nodiscard]] constexpr auto size() const noexcept -> usize { return len; }
+        [[nodiscard]] constexpr auto is_empty() const noexcept -> bool { return len == 0; }
+        [[nodiscard]] constexpr auto capacity() const noexcept -> usize { return cap; }
+        auto reserve(const usize n) -> void {
+            if (n > cap) reallocate(n);
+        }
+
+        /// contiguous storage of field `I`, e.g. for batch kernels
+        template<usize I>
+        [[nodiscard]] auto column() noexcept -> std::span<field_t<I>> { return {std::get<I>(columns), len}; }
+        template<usize I>
+        [[nodiscard]] auto column() const noexcept -> std::span<const field_t<I>> { return {std::get<I>(columns), len}; }
+
+        [[nodiscard]] auto get(const usize idx) -> reference {
+            ORC_BOUNDS_CHECK(idx < len, "index out of range");
+            return row(idx);
+        }
+        [[nodiscard]] auto get(const usize idx) const -> const_reference {
+            ORC_BOUNDS_CHECK(idx < len, "index out of range");
+            return row(idx);
+        }
+        [[nodiscard]] auto operator[](const usize idx) -> reference { return get(idx); }
+        [[nodiscard]] auto operator[](const usize idx) const -> const_reference { return get(idx); }
+        [[nodiscard]] auto get_unchecked(const usize idx) const -> const_reference {
+            ORC_DEBUG_CHECK(idx < len, "index out of range");
+            return row(idx);
+        }
+        [[nodiscard]] auto get_unchecked(const usize idx) -> reference {
+            ORC_DEBUG_CHECK(idx < len, "index out of range");
+            return row(idx);
+        }
+        auto set(const usize idx, const value_type& value) -> void { get(idx) = value; }
+
+        auto push(const Fields&... fields) -> void {
+            if (len == cap) reallocate(std::max<usize>(4, cap * 2));
+            construct_row(len, indices{}, fields...);
+            len++;
+        }
+        auto push(const value_type& value) -> void {
+            std::apply([this](const Fields&... fields) { push(fields...); }, value);
+        }
+        [[nodiscard]] auto pop() -> value_type {
+            if (len == 0) [[unlikely]] core::checks::_fail_out_of_range("empty soa_vector");
+            value_type tmp = take_row(len - 1, indices{});
+            len--;
+            return tmp;
+        }
+        auto clear() noexcept -> void {
+            for (usize i = 0; i < len; ++i) destroy_row(i, indices{});
+            len = 0;
+        }
+
+        [[nodiscard]] auto begin() -> iterator { return iterator(this, 0); }
+        [[nodiscard]] auto end() -> iterator { return iterator(this, len); }
+        [[nodiscard]] auto begin() const -> const_iterator { return const_iterator(this, 0); }
+        [[nodiscard]] auto end() const -> const_iterator { return const_iterator(this, len); }
+
+        auto format_to(format::sink& out) const -> void {
+            out.put('[');
+            for (usize i = 0; i < len; i++) {
+                if (i != 0) out.write(", ");
+                out.put('(');
+                format_row(out, i, indices{});
+                out.put(')');
+            }
+            out.put(']');
+        }
+        auto print(std::ostream& os) const -> void {
+            format::ostream_sink out(os);
+            format_to(out);
+        }
+        friend auto operator<<(std::ostream& os, const basic_soa_vector& vec) -> std::ostream& {
+            vec.print(os);
+            return os;
+        }
+
+        [[nodiscard]] static auto from_iter(std::unique_ptr<orc::iterators::iterator<value_type>> iter) -> basic_soa_vector {
+            basic_soa_vector a;
+            foreach(row, (*iter), {
+                a.push(row);
+            })
+            return a;
+        }
+
+    private:
+        std::tuple<Fields*...> columns{};
+        usize len = 0;
+        usize cap = 0;
+        Alloc allocator;
+
+        [[nodiscard]] auto row(const usize idx) noexcept -> reference {
+            return std::apply([idx](Fields*... cols) { return reference(cols[idx]...); }, columns);
+        }
+        [[nodiscard]] auto row(const usize idx) const noexcept -> const_reference {
+            return std::apply([idx](Fields*... cols) { return const_reference(cols[idx]...); }, columns);
+        }
+
+        template<usize... I>
+        auto construct_row(const usize idx, std::integer_sequence<usize, I...>, const Fields&... fields) -> void {
+            usize built = 0;
+            try {
+                ((construct_at<I>(idx, fields), ++built), ...);
+            } catch (...) {
+                // undo the columns that were already written
+                ((I < built ? destroy_at<I>(idx) : void()), ...);
+                throw;
+            }
+        }
+        template<usize I>
+        auto construct_at(const usize idx, const field_t<I>& value) -> void {
+            alloc_t<field_t<I>> a(allocator);
+            traits_t<field_t<I>>::construct(a, std::get<I>(columns) + idx, value);
+        }
+        template<usize I>
+        auto destroy_at(const usize idx) noexcept -> void {
+            alloc_t<field_t<I>> a(allocator);
+            traits_t<field_t<I>>::destroy(a, std::get<I>(columns) + idx);
+        }
+        template<usize... I>
+        auto destroy_row(const usize idx, std::integer_sequence<usize, I...>) noexcept -> void { (destroy_at<I>(idx), ...); }
+        template<usize... I>
+        auto take_row(const usize idx, std::integer_sequence<usize, I...>) -> value_type {
+            value_type tmp(std::move(std::get<I>(columns)[idx])...);
+            destroy_row(idx, indices{});
+            return tmp;
+        }
+        template<usize... I>
+        auto format_row(format::sink& out, const usize idx, std::integer_sequence<usize, I...>) const -> void {
+            ((out.write(I == 0 ? "" : ", "), format::format_to(out, std::get<I>(columns)[idx])), ...);
+        }
+
+        /// moves every column into a fresh allocation of `new_cap` rows, all-or-nothing
+        auto destroy() noexcept -> void {
+            clear();
+            release(columns, cap, indices{});
+            cap = 0;
+        }
+        auto reallocate(const usize new_cap) -> void {
+            std::tuple<Fields*...> fresh{};
+            allocate_all(fresh, new_cap, indices{});
+            move_all(fresh, new_cap, indices{});
+            release(columns, cap, indices{});
+            columns = fresh;
+            cap = new_cap;
+        }
+        template<usize... I>
+        auto allocate_all(std::tuple<Fields*...>& fresh, const usize n, std::integer_sequence<usize, I...>) -> void {
+            try {
+                ((std::get<I>(fresh) = allocate<I>(n)), ...);
+            } catch (...) {
+                release(fresh, n, indices{});
+                throw;
+            }
+        }
+        template<usize I>
+        auto allocate(const usize n) -> field_t<I>* {
+            alloc_t<field_t<I>> a(allocator);
+            return traits_t<field_t<I>>::allocate(a, n);
+        }
+        template<usize... I>
+        auto release(std::tuple<Fields*...>& cols, const usize n, std::integer_sequence<usize, I...>) noexcept -> void {
+            ((std::get<I>(cols) != nullptr ? deallocate<I>(std::get<I>(cols), n) : void()), ...);
+            cols = {};
+        }
+        template<usize I>
+        auto deallocate(field_t<I>* p, const usize n) noexcept -> void {
+            alloc_t<field_t<I>> a(allocator);
+            traits_t<field_t<I>>::deallocate(a, p, n);
+        }
+        template<usize... I>
+        auto move_all(std::tuple<Fields*...>& fresh, const usize new_cap, std::integer_sequence<usize, I...>) -> void {
+            usize moved = 0;
+            try {
+                ((move_column<I>(std::get<I>(fresh)), ++moved), ...);
+            } catch (...) {
+                ((I < moved ? destroy_column<I>(std::get<I>(fresh)) : void()), ...);
+                release(fresh, new_cap, indices{});
+                throw;
+            }
+            destroy_all(indices{});
+        }
+        template<usize I>
+        auto move_column(field_t<I>* dst) -> void {
+            field_t<I>* src = std::get<I>(columns);
+            if constexpr (std::is_nothrow_move_constructible_v<field_t<I>>)
+                std::uninitialized_move(src, src + len, dst);
+            else
+                std::uninitialized_copy(src, src + len, dst);
+        }
+        template<usize I>
+        auto destroy_column(field_t<I>* p) noexcept -> void { std::destroy(p, p + len); }
+        template<usize... I>
+        auto destroy_all(std::integer_sequence<usize, I...>) noexcept -> void { (destroy_column<I>(std::get<I>(columns)), ...); }
+    };
+
+    template<typename... Fields>
+    using soa_vector = basic_soa_vector<std::allocator<std::byte>, Fields...>;
+
+    template<class Alloc, typename... Fields>
+    class ORC_API soa_vector_iterator final : public orc::iterators::iterator<std::tuple<Fields...>> {
+    public:
+        using vec_t = basic_soa_vector<Alloc, Fields...>;
+        explicit soa_vector_iterator(const vec_t& vec) : vec(&vec) {}
+        auto clone() const -> std::unique_ptr<orc::iterators::iterator<std::tuple<Fields...>>> override {
+            ORC_RECORD(soa_vector_iterator, IteratorClone, 1);
+            return std::make_unique<soa_vector_iterator>(*this);
+        }
+        [[nodiscard]] auto has_next() const noexcept -> bool override { return pos != vec->size(); }
+        [[nodiscard]] auto next() -> std::tuple<Fields...> override {
+            if (!has_next()) _end_iteration<soa_vector_iterator>();
+            return std::tuple<Fields...>((*vec)[pos++]);
+        }
+        [[nodiscard]] auto try_next() -> orc::optional::optional<std::tuple<Fields...>> override {
+            if (!has_next()) return orc::optional::none;
+            return orc::optional::some(std::tuple<Fields...>((*vec)[pos++]));
+        }
+    private:
+        const vec_t* vec;
+        usize pos = 0;
+    };
+}
@@ -0,0 +1,256 @@
+#pragma once
+
+#include <orc_export.hpp>
+#include <ordefs.hpp>
+#include <checks.hpp>
+#include <container.hpp>
+#include <initializer_list>
+#include <memory>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "iterator.hpp"
+
+using namespace orc::core::container;
+using namespace orc::core::defines;
+using namespace orc::iterators;
+
+namespace orc::containers {
+
+    /// elements which can live in a plain array are default-initialized up front, which keeps them
+    /// usable in constant expressions. the others are constructed in place inside a union
+    template<typename T>
+    inline constexpr bool _static_inline_init = std::is_default_constructible_v<T> && std::is_trivially_destructible_v<T>
+        && std::is_move_assignable_v<T>;
+
+    template<typename T, usize N, bool = _static_inline_init<T>>
+    struct _static_storage {
+        T elems[N]{};
+
+        template<typename... Args>
+        constexpr auto construct(const usize idx, Args&&... args) -> void { elems[idx] = T(std::forward<Args>(args)...); }
+        constexpr auto destroy(const usize) noexcept -> void {}
+    };
+    template<typename T, usize N>
+    struct _static_storage<T, N, false> {
+        union { T elems[N]; };
+
+        constexpr _static_storage() noexcept {}
+        constexpr ~_static_storage() {}
+
+        template<typename... Args>
+        constexpr auto construct(const usize idx, Args&&... args) -> void { std::construct_at(elems + idx, std::forward<Args>(args)...); }
+        constexpr auto destroy(const usize idx) noexcept -> void { std::destroy_at(elems + idx); }
+    };
+
+    template<typename T, usize N>
+    class ORC_API static_vector_container;
+
+    /// fixed-capacity vector with inline storage, never allocates. it is a literal type, so tables can be
+    /// built in `constexpr` variables; `as_container` exposes it through the `stack_container` interface
+    template<typename T, usize N>
+    class ORC_API static_vector {
+        static_assert(N > 0, "static vector capacity must be positive");
+    public:
+        using value_type = T;
+
+        constexpr static_vector() = default;
+        constexpr static_vector(std::initializer_list<T> init) {
+            if (init.size() > N) throw std::out_of_range("static vector is full");
+            for (const auto& t : init) emplace(t);
+        }
+        constexpr static_vector(const static_vector&) requires _static_inline_init<T> = default;
+        constexpr static_vector(const static_vector& other) {
+            for (usize i = 0; i < other.len; ++i) emplace(other.storage.elems[i]);
+        }
+        constexpr static_vector(static_vector&&) noexcept requires _static_inline_init<T> = default;
+        constexpr static_vector(static_vector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+            for (usize i = 0; i < other.len; ++i) emplace(std::move(other.storage.elems[i]));
+            other.clear();
+        }
+        constexpr auto operator=(const static_vector&) -> static_vector& requires _static_inline_init<T> = default;
+        constexpr auto operator=(const static_vector& other) -> static_vector& {
+            if (this == &other) return *this;
+            clear();
+            for (usize i = 0; i < other.len; ++i) emplace(other.storage.elems[i]);
+            return *this;
+        }
+        constexpr auto operator=(static_vector&&) noexcept -> static_vector& requires _static_inline_init<T> = default;
+        constexpr auto operator=(static_vector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) -> static_vector& {
+            if (this == &other) return *this;
+            clear();
+            for (usize i = 0; i < other.len; ++i) emplace(std::move(other.storage.elems[i]));
+            other.clear();
+            return *this;
+        }
+        constexpr ~static_vector() requires _static_inline_init<T> = default;
+        constexpr ~static_vector() { clear(); }
+
+        [[nodiscard]] constexpr auto start() const noexcept -> const T* { return storage.elems; }
+        [[nodiscard]] constexpr auto start() noexcept -> T* { return storage.elems; }
+        [[nodiscard]] constexpr auto end() const noexcept -> const T* { return storage.elems + len; }
+        [[nodiscard]] constexpr auto end() noexcept -> T* { return storage.elems + len; }
+        /// `start`/`end` under the standard names, so `static_vector` models `std::ranges::contiguous_range`
+        [[nodiscard]] constexpr auto begin() const noexcept -> const T* { return storage.elems; }
+        [[nodiscard]] constexpr auto begin() noexcept -> T* { return storage.elems; }
+        [[nodiscard]] constexpr auto data() const noexcept -> const T* { return storage.elems; }
+        [[nodiscard]] constexpr auto data() noexcept -> T* { return storage.elems; }
+        [[nodiscard]] constexpr auto as_span() const noexcept -> std::span<const T> { return {storage.elems, len}; }
+        [[nodiscard]] constexpr auto as_span() noexcept -> std::span<T> { return {storage.elems, len}; }
+
+        [[nodiscard]] constexpr auto size() const noexcept -> usize { return len; }
+        [[nodiscard]] constexpr auto is_empty() const noexcept -> bool { return len == 0; }
+        [[nodiscard]] constexpr auto is_full() const noexcept -> bool { return len == N; }
+        [[nodiscard]] static constexpr auto capacity() noexcept -> usize { return N; }
+
+        [[nodiscard]] constexpr auto get(const usize idx) const -> const T& {
+            ORC_BOUNDS_CHECK(idx < len, "index out of range");
+            return storage.elems[idx];
+        }
+        [[nodiscard]] constexpr auto get(const usize idx) -> T& {
+            ORC_BOUNDS_CHECK(idx < len, "index out of range");
+            return storage.elems[idx];
+        }
+        [[nodiscard]] constexpr auto operator[](const usize idx) const -> const T& { return get(idx); }
+        [[nodiscard]] constexpr auto operator[](const usize idx) -> T& { return get(idx); }
+        [[nodiscard]] constexpr auto get_unchecked(const usize idx) const -> const T& {
+            ORC_DEBUG_CHECK(idx < len, "index out of range");
+            return storage.elems[idx];
+        }
+        [[nodiscard]] constexpr auto get_unchecked(const usize idx) -> T& {
+            ORC_DEBUG_CHECK(idx < len, "index out of range");
+            return storage.elems[idx];
+        }
+        constexpr auto set(const usize idx, const T& value) -> void { get(idx) = value; }
+
+        [[nodiscard]] constexpr auto top() const -> const T& {
+            if (len == 0) [[unlikely]] core::checks::_fail_out_of_range("empty static vector");
+            return storage.elems[len - 1];
+        }
+        [[nodiscard]] constexpr auto top() -> T& {
+            if (len == 0) [[unlikely]] core::checks::_fail_out_of_range("empty static vector");
+            return storage.elems[len - 1];
+        }
+
+        constexpr auto push(const T& value) -> void {
+            if (len == N) [[unlikely]] core::checks::_fail_out_of_range("static vector is full");
+            emplace(value);
+        }
+        /// returns false instead of throwing when full
+        constexpr auto try_push(T value) -> bool {
+            if (len == N) return false;
+            emplace(std::move(value));
+            return true;
+        }
+        [[nodiscard]] constexpr auto pop() -> T {
+            if (len == 0) [[unlikely]] core::checks::_fail_out_of_range("empty static vector");
+            T tmp = std::move(storage.elems[len - 1]);
+            storage.destroy(--len);
+            return tmp;
+        }
+        constexpr auto clear() noexcept -> void {
+            while (len > 0) storage.destroy(--len);
+        }
+
+        [[nodiscard]] constexpr auto operator==(const static_vector& other) const -> bool {
+            if (len != other.len) return false;
+            for (usize i = 0; i < len; ++i)
+                if (!(storage.elems[i] == other.storage.elems[i])) return false;
+            return true;
+        }
+
+        /// view implementing `stack_container`, valid while this vector is alive
+        [[nodiscard]] auto as_container() -> static_vector_container<T, N> { return static_vector_container<T, N>(*this); }
+
+        auto format_to(format::sink& out) const -> void {
+            out.put('[');
+            for (usize i = 0; i < len; i++) {
+                if (i != 0) out.write(", ");
+                format::format_to(out, storage.elems[i]);
+            }
+            out.put(']');
+        }
+        auto print(std::ostream& os) const -> void {
+            format::ostream_sink out(os);
+            format_to(out);
+        }
+        friend auto operator<<(std::ostream& os, const static_vector& obj) -> std::ostream& {
+            obj.print(os);
+            return os;
+        }
+
+        /// takes at most `N` items, throws `std::out_of_range` when the iterator has more
+        [[nodiscard]] static auto from_iter(std::unique_ptr<iterator<T>> iter) -> static_vector {
+            static_vector a;
+            foreach(i, (*iter), {
+                a.push(i);
+            })
+            return a;
+        }
+
+    private:
+        _static_storage<T, N> storage;
+        usize len = 0;
+
+        template<typename... Args>
+        constexpr auto emplace(Args&&... args) -> void {
+            storage.construct(len, std::forward<Args>(args)...);
+            len++;
+        }
+    };
+
+    /// `stack_container` over a `static_vector`. the virtual bases keep it out of constant expressions,
+    /// which is why the vector itself does not derive from the interface
+    template<typename T, usize N>
+    class ORC_API static_vector_container final : public stack_container<T> {
+    public:
+        explicit static_vector_container(static_vector<T, N>& vec) : vec(&vec) {}
+
+        [[nodiscard]] auto size() const noexcept -> usize override { return vec->size(); }
+        [[nodiscard]] auto is_empty() const noexcept -> bool override { return vec->is_empty(); }
+        [[nodiscard]] auto get(const usize idx) const -> const T& override { return std::as_const(*vec).get(idx); }
+        [[nodiscard]] auto operator[](const usize idx) const -> const T& override { return std::as_const(*vec).get(idx); }
+        auto set(const usize idx, const T& value) -> void override { vec->set(idx, value); }
+        [[nodiscard]] auto get(const usize idx) -> T& override { return vec->get(idx); }
+        [[nodiscard]] auto operator[](const usize idx) -> T& override { return vec->get(idx); }
+        [[nodiscard]] auto top() const -> const T& override { return std::as_const(*vec).top(); }
+        [[nodiscard]] auto top() -> T& override { return vec->top(); }
+        auto push(const T& value) -> void override { vec->push(value); }
+        [[nodiscard]] auto pop() -> T override { return vec->pop(); }
+        auto format_to(format::sink& out) const -> void override { vec->format_to(out); }
+        auto print(std::ostream& os) const -> void override { vec->print(os); }
+
+    private:
+        static_vector<T, N>* vec;
+    };
+
+    template<typename T, usize N>
+    class ORC_API static_vector_iterator final : public iterator<T> {
+    public:
+        explicit static_vector_iterator(static_vector<T, N>& vec) {
+            begin = vec.start();
+            end = vec.end();
+        }
+        auto clone() const -> std::unique_ptr<iterator<T>> override {
+            ORC_RECORD(static_vector_iterator, IteratorClone, 1);
+            return std::make_unique<static_vector_iterator>(*this);
+        }
+        [[nodiscard]] constexpr auto has_next() const noexcept -> bool override { return begin + pos != end; }
+        [[nodiscard]] constexpr auto next() -> typename iterator<T>::value_type override {
+            if (!has_next()) _end_iteration<static_vector_iterator>();
+            return *(begin + pos++);
+        }
+        [[nodiscard]] constexpr auto try_next() -> orc::optional::optional<T> override {
+            if (!has_next()) return orc::optional::none;
+            return orc::optional::some(*(begin + pos++));
+        }
+        /// elements not consumed yet
+        [[nodiscard]] constexpr auto as_span() const noexcept -> std::span<T> { return {begin + pos, end}; }
+    private:
+        T* begin = nullptr;
+        T* end = nullptr;
+        usize pos = 0;
+    };
+}
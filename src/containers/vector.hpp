@@ -2,9 +2,13 @@
 
 #include <orc_export.hpp>
 #include <ordefs.hpp>
+#include <checks.hpp>
 #include <container.hpp>
+#include <functional>
 #include <memory>
 #include <ostream>
+#include <span>
+#include "instrument.hpp"
 #include "iterator.hpp"
 
 using namespace orc::core::container;
@@ -20,9 +24,10 @@ namespace orc::containers {
         vector(std::initializer_list<T> init) {
             reallocate_and_grow(init.size()+1);
             for (auto t : init) {
-                alloc_traits::construct(allocator, data + len, t);
+                alloc_traits::construct(allocator, buffer + len, t);
                 len++;
             }
+            ORC_RECORD(vector, Construction, len);
         }
         explicit vector(const usize initial_cap) {
             reallocate_and_grow(initial_cap);
@@ -30,75 +35,121 @@ namespace orc::containers {
         vector() { reallocate_and_grow(4); }
 
         vector(const vector& other) {
-            if (other.data != nullptr) {
-                data = alloc_traits::allocate(allocator, other.cap);
+            if (other.buffer != nullptr) {
+                buffer = alloc_traits::allocate(allocator, other.cap);
                 cap = other.cap;
                 for (usize i = 0; i < other.len; i++) {
-                    alloc_traits::construct(allocator, data + len, other.data[i]);
+                    alloc_traits::construct(allocator, buffer + len, other.buffer[i]);
                     len++;
                 }
                 allocator = other.allocator;
-            } else data = nullptr;
+                ORC_RECORD(vector, Allocation, 1);
+                ORC_RECORD(vector, Construction, len);
+                ORC_RECORD(vector, BytesCopied, len * sizeof(T));
+            } else buffer = nullptr;
         }
         vector(vector&& other) noexcept {
-            data = other.data;
+            buffer = other.buffer;
             cap = other.cap;
             len = other.len;
             allocator = std::move(other.allocator);
-            other.data = nullptr;
+            other.buffer = nullptr;
         }
 
         ~vector() override {
-            if (data != nullptr) {
-                destroy_range(data, len);
-                deallocate(data, cap);
+            if (buffer != nullptr) {
+                destroy_range(buffer, len);
+                deallocate(buffer, cap);
             }
         }
 
-        [[nodiscard]] constexpr auto start() const -> T* { return data; }
-        [[nodiscard]] constexpr auto end() const -> T* { return data + len; }
+        [[nodiscard]] constexpr auto start() const noexcept -> const T* { return buffer; }
+        [[nodiscard]] constexpr auto start() noexcept -> T* { return buffer; }
+        [[nodiscard]] constexpr auto data() noexcept -> T* { return buffer; }
+        [[nodiscard]] constexpr auto data() const noexcept -> const T* { return buffer; }
+        [[nodiscard]] constexpr auto as_span() noexcept -> std::span<T> { return {buffer, len}; }
+        [[nodiscard]] constexpr auto as_span() const noexcept -> std::span<const T> { return {buffer, len}; }
+        /// pointer iterators, so `vector` models `std::ranges::contiguous_range`
+        [[nodiscard]] constexpr auto begin() noexcept -> T* { return buffer; }
+        [[nodiscard]] constexpr auto end() noexcept -> T* { return buffer + len; }
+        [[nodiscard]] constexpr auto begin() const noexcept -> const T* { return buffer; }
+        [[nodiscard]] constexpr auto end() const noexcept -> const T* { return buffer + len; }
 
         [[nodiscard]] constexpr auto size() const noexcept -> usize override { return len; }
         [[nodiscard]] constexpr auto is_empty() const noexcept -> bool override { return len == 0; }
         [[nodiscard]] constexpr auto get(const usize idx) const -> const T& override {
-            if (idx >= len) throw std::out_of_range("index out of range");
-            return data[idx];
+            ORC_BOUNDS_CHECK(idx < len, "index out of range");
+            return buffer[idx];
         }
         [[nodiscard]] constexpr auto operator[](const usize idx) const -> const T& override { return get(idx); }
 
         constexpr auto set(const usize idx, const T& value) -> void override {
-            if (idx >= len) throw std::out_of_range("index out of range");
-            alloc_traits::destroy(allocator, data + idx);
-            alloc_traits::construct(allocator, data + idx, value);
+            ORC_BOUNDS_CHECK(idx < len, "index out of range");
+            alloc_traits::destroy(allocator, buffer + idx);
+            alloc_traits::construct(allocator, buffer + idx, value);
+            ORC_RECORD(vector, Construction, 1);
         }
         constexpr auto get(const usize idx) -> T& override {
-            if (idx >= len) throw std::out_of_range("index out of range");
-            return data[idx];
+            ORC_BOUNDS_CHECK(idx < len, "index out of range");
+            return buffer[idx];
         }
         constexpr auto operator[](const usize idx) -> T& override { return get(idx); }
+        /// skips the bounds check below `ORC_CHECKS` level 2, for loops which already know their range
+        [[nodiscard]] constexpr auto get_unchecked(const usize idx) const -> const T& {
+            ORC_DEBUG_CHECK(idx < len, "index out of range");
+            return buffer[idx];
+        }
+        [[nodiscard]] constexpr auto get_unchecked(const usize idx) -> T& {
+            ORC_DEBUG_CHECK(idx < len, "index out of range");
+            return buffer[idx];
+        }
 
         constexpr auto top() const -> const T& override { return get(len - 1); }
         constexpr auto top() -> T& override { return get(0); }
 
         constexpr auto push(const T& value) -> void override {
-            if (len >= cap) reallocate_and_grow(cap+1);
-            alloc_traits::construct(allocator, data + len, value);
+            const T* src = &value;
+            if (len >= cap) {
+                // `value` may be one of our own elements, find it again after the move
+                const usize at = index_of(src);
+                reallocate_and_grow(cap+1);
+                if (at != len) src = buffer + at;
+            }
+            alloc_traits::construct(allocator, buffer + len, *src);
             len++;
+            ORC_RECORD(vector, Construction, 1);
+        }
+        /// appends all of `values`, trivially copyable elements are copied in one go
+        auto push(std::span<const T> values) -> void {
+            if (len + values.size() > cap) {
+                // `values` may be a view of our own elements, which keep their indices when moved
+                const usize at = values.empty() ? len : index_of(values.data());
+                reallocate_and_grow(len + values.size());
+                if (at != len) values = {buffer + at, values.size()};
+            }
+            std::uninitialized_copy(values.begin(), values.end(), buffer + len);
+            len += values.size();
+            ORC_RECORD(vector, Construction, values.size());
+            ORC_RECORD(vector, BytesCopied, values.size_bytes());
         }
         constexpr auto pop() -> T override {
-            if (len == 0) throw std::out_of_range("empty vector");
-            const T tmp = data[len - 1];
-            alloc_traits::destroy(allocator, data + len - 1);
+            if (len == 0) [[unlikely]] core::checks::_fail_out_of_range("empty vector");
+            const T tmp = buffer[len - 1];
+            alloc_traits::destroy(allocator, buffer + len - 1);
             len--;
             return tmp;
         }
-        constexpr auto print(std::ostream& os) const -> void override {
-            os << '[';
+        auto format_to(format::sink& out) const -> void override {
+            out.put('[');
             for (usize i = 0; i < len; i++) {
-                os << get(i);
-                if (i != len - 1) os << ", ";
+                if (i != 0) out.write(", ");
+                format::format_to(out, buffer[i]);
             }
-            os << ']';
+            out.put(']');
+        }
+        auto print(std::ostream& os) const -> void override {
+            format::ostream_sink out(os);
+            format_to(out);
         }
 
         [[nodiscard]] static auto from_iter(std::unique_ptr<iterator<T>> iter) -> vector {
@@ -110,13 +161,20 @@ namespace orc::containers {
         }
 
     private:
-        T* data = nullptr;
+        T* buffer = nullptr;
         usize cap = 0;
         usize len = 0;
         Alloc allocator;
 
+        /// index of `p` when it points into the live elements, `len` otherwise
+        [[nodiscard]] auto index_of(const T* p) const noexcept -> usize {
+            const std::less<const T*> before;
+            if (buffer == nullptr || before(p, buffer) || !before(p, buffer + len)) return len;
+            return static_cast<usize>(p - buffer);
+        }
         auto allocate(usize n) -> T* {
             if (n == 0) return nullptr;
+            ORC_RECORD(vector, Allocation, 1);
             return alloc_traits::allocate(allocator, n);
         }
         auto deallocate(T* p, const usize n) -> void {
@@ -133,9 +191,9 @@ namespace orc::containers {
             usize moved = 0;
             try {
                 if constexpr (std::is_nothrow_move_constructible_v<T>)
-                    std::uninitialized_move(data, data + len, new_data);
+                    std::uninitialized_move(buffer, buffer + len, new_data);
                 else
-                    std::uninitialized_copy(data, data + len, new_data);
+                    std::uninitialized_copy(buffer, buffer + len, new_data);
                 moved = len;
             } catch (...) {
                 destroy_range(new_data, moved);
@@ -143,10 +201,15 @@ namespace orc::containers {
                 throw;
             }
 
-            destroy_range(data, len);
-            deallocate(data, cap);
+            if (buffer != nullptr) {
+                ORC_RECORD(vector, Reallocation, 1);
+                if constexpr (std::is_nothrow_move_constructible_v<T>) ORC_RECORD(vector, BytesMoved, len * sizeof(T));
+                else ORC_RECORD(vector, BytesCopied, len * sizeof(T));
+            }
+            destroy_range(buffer, len);
+            deallocate(buffer, cap);
 
-            data = new_data;
+            buffer = new_data;
             cap = target;
         }
     };
@@ -159,15 +222,22 @@ namespace orc::containers {
             end = vec.end();
         }
         auto clone() const -> std::unique_ptr<iterator<T>> override {
+            ORC_RECORD(vector_iterator, IteratorClone, 1);
             return std::make_unique<vector_iterator>(*this);
         }
         [[nodiscard]] constexpr auto has_next() const noexcept -> bool override { return begin+pos != end; }
         [[nodiscard]] constexpr auto next() -> typename iterator<T>::value_type override {
-            if (!has_next()) throw iteration_end{};
+            if (!has_next()) _end_iteration<vector_iterator>();
             auto tmp = *(begin + pos);
             pos++;
             return tmp;
         }
+        [[nodiscard]] constexpr auto try_next() -> orc::optional::optional<T> override {
+            if (!has_next()) return orc::optional::none;
+            return orc::optional::some(*(begin + pos++));
+        }
+        /// elements not consumed yet
+        [[nodiscard]] constexpr auto as_span() const noexcept -> std::span<T> { return {begin + pos, end}; }
     private:
         T* begin = nullptr;
         T* end = nullptr;
@@ -0,0 +1,42 @@
+#pragma once
+#include <stdexcept>
+#include <orc_export.hpp>
+#include <ordefs.hpp>
+
+/// build-wide check level, define `ORC_CHECKS` for the whole program to pick one:
+/// 0 - no index checks, out of range `get`/`operator[]`/`set` is undefined behaviour
+/// 1 - those accessors throw `std::out_of_range` (the default with `NDEBUG`)
+/// 2 - as 1, plus `ORC_ASSERT`/`ORC_DEBUG_CHECK` and the `*_unchecked` accessors are verified (the default otherwise)
+/// capacity and empty checks of `push`, `pop` and `top` always throw, whatever the level
+#ifndef ORC_CHECKS
+#ifdef NDEBUG
+#define ORC_CHECKS 1
+#else
+#define ORC_CHECKS 2
+#endif
+#endif
+
+/// throws `std::out_of_range(msg)` from a cold out-of-line call when `cond` is false
+#if ORC_CHECKS >= 1
+#define ORC_BOUNDS_CHECK(cond, msg) \
+    do { if (!(cond)) [[unlikely]] ::orc::core::checks::_fail_out_of_range(msg); } while (false)
+#else
+#define ORC_BOUNDS_CHECK(cond, msg) ((void)sizeof(!(cond)))
+#endif
+
+/// bounds check kept only at level 2, guards the accessors that skip `ORC_BOUNDS_CHECK`
+#if ORC_CHECKS >= 2
+#define ORC_DEBUG_CHECK(cond, msg) ORC_BOUNDS_CHECK(cond, msg)
+#else
+#define ORC_DEBUG_CHECK(cond, msg) ((void)sizeof(!(cond)))
+#endif
+
+namespace orc::core::checks {
+
+    /// check level the including translation unit was built with
+    inline constexpr int LEVEL = ORC_CHECKS;
+
+    [[noreturn]] ORC_COLD ORC_API inline auto _fail_out_of_range(const char* msg) -> void {
+        throw std::out_of_range(msg);
+    }
+}
@@ -1,6 +1,8 @@
 #pragma once
 #include <orc_export.hpp>
 #include <ordefs.hpp>
+#include <ostream>
+#include "format.hpp"
 
 using namespace orc::core::defines;
 
@@ -15,6 +17,12 @@ namespace orc::core::container {
         [[nodiscard]] constexpr virtual auto get(usize) const -> const T& = 0;
         [[nodiscard]] constexpr virtual auto operator[](usize) const -> const T& = 0;
         constexpr virtual auto print(std::ostream&) const -> void = 0;
+        /// same text as `print`, overridden by containers which can skip iostreams
+        virtual auto format_to(format::sink& out) const -> void {
+            format::_sink_streambuf buf(out);
+            std::ostream os(&buf);
+            print(os);
+        }
         friend auto operator<<(std::ostream& os, const container& obj) -> std::ostream& {
             obj.print(os);
             return os;
@@ -51,6 +59,17 @@ namespace orc::core::container {
         [[nodiscard]] constexpr virtual auto pop() -> T = 0;
     };
 
+    /// fifo container: `push` appends to the back, `pop` removes from the front
+    template<typename T, class Alloc = std::allocator<T>>
+    class ORC_API queue_container : public virtual mutable_container<T, Alloc> {
+    public:
+        ~queue_container() override = default;
+        [[nodiscard]] constexpr virtual auto front() const -> const T& = 0;
+        [[nodiscard]] constexpr virtual auto front() -> T& = 0;
+        constexpr virtual auto push(const T&) -> void = 0;
+        [[nodiscard]] constexpr virtual auto pop() -> T = 0;
+    };
+
     template<typename T>
     auto operator<<(std::ostream& os, const std::shared_ptr<container<T>>& obj) -> std::ostream& {
         os << *obj;
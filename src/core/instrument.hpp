@@ -0,0 +1,152 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <typeinfo>
+#include <vector>
+#include <orc_export.hpp>
+#include <ordefs.hpp>
+#if defined(ORC_INSTRUMENT) && defined(__GNUG__)
+#include <cxxabi.h>
+#endif
+
+#include "format.hpp"
+
+using namespace orc::core::defines;
+
+/// opt-in operation counters. define `ORC_INSTRUMENT` for the whole program to enable them,
+/// otherwise every `ORC_RECORD` compiles to nothing and the stats API reports no types
+#ifdef ORC_INSTRUMENT
+#define ORC_RECORD(type, ev, n) ::orc::core::instrument::_record<type>(::orc::core::instrument::event::ev, n)
+#else
+#define ORC_RECORD(type, ev, n) ((void)0)
+#endif
+
+namespace orc::core::instrument {
+
+    enum class ORC_API event {
+        Allocation,
+        Reallocation,
+        BytesMoved,
+        BytesCopied,
+        Construction,
+        IteratorClone,
+        IterationEnd,
+    };
+    inline constexpr usize EVENT_COUNT = 7;
+
+#ifdef ORC_INSTRUMENT
+    inline constexpr bool ENABLED = true;
+#else
+    inline constexpr bool ENABLED = false;
+#endif
+
+    [[nodiscard]] ORC_API constexpr auto event_name(const event ev) noexcept -> std::string_view {
+        switch (ev) {
+            case event::Allocation: return "allocations";
+            case event::Reallocation: return "reallocations";
+            case event::BytesMoved: return "bytes_moved";
+            case event::BytesCopied: return "bytes_copied";
+            case event::Construction: return "constructions";
+            case event::IteratorClone: return "iterator_clones";
+            case event::IterationEnd: return "iteration_ends";
+        }
+        return "unknown";
+    }
+
+    /// counters of one type at the time of the snapshot
+    struct ORC_API type_stats {
+        std::string type;
+        std::array<u64, EVENT_COUNT> counts{};
+
+        [[nodiscard]] constexpr auto operator[](const event ev) const noexcept -> u64 { return counts[static_cast<usize>(ev)]; }
+
+        auto format_to(format::sink& out) const -> void {
+            out << type << ':';
+            for (usize i = 0; i < EVENT_COUNT; ++i) {
+                if (counts[i] == 0) continue;
+                out << ' ' << event_name(static_cast<event>(i)) << '=' << counts[i];
+            }
+        }
+    };
+
+    /// lock-free intrusive list node, one per instrumented type, never destroyed
+    struct _type_counters {
+        const char* type;
+        std::array<std::atomic<u64>, EVENT_COUNT> counts{};
+        _type_counters* next = nullptr;
+    };
+    inline std::atomic<_type_counters*> _registry{nullptr};
+
+    template<typename T>
+    [[nodiscard]] auto _counters() -> _type_counters& {
+        static _type_counters self{typeid(T).name()};
+        static const bool registered = [] {
+            self.next = _registry.load(std::memory_order_relaxed);
+            while (!_registry.compare_exchange_weak(self.next, &self, std::memory_order_release, std::memory_order_relaxed));
+            return true;
+        }();
+        (void)registered;
+        return self;
+    }
+    template<typename T>
+    constexpr auto _record(const event ev, const usize n) -> void {
+        if (std::is_constant_evaluated() || n == 0) return;
+        _counters<T>().counts[static_cast<usize>(ev)].fetch_add(n, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] inline auto _demangle(const char* name) -> std::string {
+#if defined(ORC_INSTRUMENT) && defined(__GNUG__)
+        int status = 0;
+        const std::unique_ptr<char, decltype(&std::free)> readable(abi::__cxa_demangle(name, nullptr, nullptr, &status), &std::free);
+        if (status == 0 && readable) return readable.get();
+#endif
+        return name;
+    }
+
+    /// counters of every type that recorded at least one event, sorted by type name
+    [[nodiscard]] ORC_API inline auto snapshot() -> std::vector<type_stats> {
+        std::vector<type_stats> out;
+        for (const _type_counters* c = _registry.load(std::memory_order_acquire); c != nullptr; c = c->next) {
+            type_stats stats{_demangle(c->type)};
+            for (usize i = 0; i < EVENT_COUNT; ++i) stats.counts[i] = c->counts[i].load(std::memory_order_relaxed);
+            out.push_back(std::move(stats));
+        }
+        std::sort(out.begin(), out.end(), [](const type_stats& l, const type_stats& r) { return l.type < r.type; });
+        return out;
+    }
+    /// counters of `T`, all zero when instrumentation is disabled
+    template<typename T>
+    [[nodiscard]] ORC_API auto get() -> type_stats {
+        type_stats stats{_demangle(typeid(T).name())};
+        if constexpr (ENABLED)
+            for (usize i = 0; i < EVENT_COUNT; ++i) stats.counts[i] = _counters<T>().counts[i].load(std::memory_order_relaxed);
+        return stats;
+    }
+    /// zeroes every counter, events recorded concurrently may survive
+    ORC_API inline auto reset() noexcept -> void {
+        for (_type_counters* c = _registry.load(std::memory_order_acquire); c != nullptr; c = c->next)
+            for (auto& count : c->counts) count.store(0, std::memory_order_relaxed);
+    }
+
+    /// one line per type
+    ORC_API inline auto dump(format::sink& out) -> void {
+        for (const auto& stats : snapshot()) out << stats << '\n';
+    }
+    /// dumps to stderr when the program exits normally, repeated calls register once
+    ORC_API inline auto dump_at_exit() -> void {
+        static const bool registered = [] {
+            std::atexit([] {
+                format::fd_sink err(2);
+                dump(err);
+            });
+            return true;
+        }();
+        (void)registered;
+    }
+}
@@ -0,0 +1,234 @@
+#pragma once
+#include <orc_export.hpp>
+#include <ordefs.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+using namespace orc::core::defines;
+
+namespace orc::core {
+
+    enum class ORC_API map_mode {
+        ReadOnly,
+        ReadWrite,
+    };
+
+    /// expected access pattern of a mapped range, forwarded to the kernel where it has an equivalent
+    enum class ORC_API access_hint {
+        Normal,
+        Sequential,
+        Random,
+        WillNeed,
+        DontNeed,
+    };
+
+    /// whole-file shared mapping. `ReadWrite` files are created when missing and can be resized,
+    /// the mapping address may change on every resize
+    class ORC_API mapped_file {
+    public:
+        mapped_file() = default;
+        mapped_file(const std::string& path, const map_mode mode) : mode(mode) {
+            try {
+#ifdef _WIN32
+                const bool rw = mode == map_mode::ReadWrite;
+                file = CreateFileA(path.c_str(), GENERIC_READ | (rw ? GENERIC_WRITE : 0), FILE_SHARE_READ | FILE_SHARE_WRITE,
+                                   nullptr, rw ? OPEN_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+                if (file == INVALID_HANDLE_VALUE) throw_last_error("CreateFileA");
+                LARGE_INTEGER file_size;
+                if (!GetFileSizeEx(file, &file_size)) throw_last_error("GetFileSizeEx");
+                len = static_cast<usize>(file_size.QuadPart);
+#else
+                fd = ::open(path.c_str(), mode == map_mode::ReadWrite ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+                if (fd < 0) throw_last_error("open");
+                struct stat st{};
+                if (::fstat(fd, &st) != 0) throw_last_error("fstat");
+                len = static_cast<usize>(st.st_size);
+#endif
+                map();
+            } catch (...) {
+                close();
+                throw;
+            }
+        }
+        mapped_file(const mapped_file&) = delete;
+        auto operator=(const mapped_file&) -> mapped_file& = delete;
+        mapped_file(mapped_file&& other) noexcept { swap(other); }
+        auto operator=(mapped_file&& other) noexcept -> mapped_file& {
+            mapped_file tmp(std::move(other));
+            swap(tmp);
+            return *this;
+        }
+        ~mapped_file() { close(); }
+
+        [[nodiscard]] constexpr auto data() const noexcept -> u8* { return ptr; }
+        [[nodiscard]] constexpr auto size() const noexcept -> usize { return len; }
+        [[nodiscard]] constexpr auto is_open() const noexcept -> bool {
+#ifdef _WIN32
+            return file != INVALID_HANDLE_VALUE;
+#else
+            return fd >= 0;
+#endif
+        }
+
+        /// grows or truncates the file and remaps it
+        auto resize(const usize new_size) -> void {
+            if (mode != map_mode::ReadWrite) throw std::runtime_error("file is mapped read-only");
+            if (new_size == len) return;
+#ifdef _WIN32
+            // a view keeps its section alive, so the file can only change size once it is unmapped
+            unmap();
+            LARGE_INTEGER target;
+            target.QuadPart = static_cast<LONGLONG>(new_size);
+            if (!SetFilePointerEx(file, target, nullptr, FILE_BEGIN) || !SetEndOfFile(file)) throw_last_error("SetEndOfFile");
+            len = new_size;
+            map();
+#else
+            if (::ftruncate(fd, static_cast<off_t>(new_size)) != 0) throw_last_error("ftruncate");
+#ifdef __linux__
+            if (ptr != nullptr && new_size != 0) {
+                void* moved = ::mremap(ptr, len, new_size, MREMAP_MAYMOVE);
+                if (moved == MAP_FAILED) throw_last_error("mremap");
+                ptr = static_cast<u8*>(moved);
+                len = new_size;
+                return;
+            }
+#endif
+            unmap();
+            len = new_size;
+            map();
+#endif
+        }
+
+        /// writes dirty pages of `[offset, offset + count)` back to the file and waits for the device
+        auto flush(const usize offset = 0, usize count = static_cast<usize>(-1)) -> void {
+            if (ptr == nullptr || mode != map_mode::ReadWrite || offset >= len) return;
+            count = std::min<usize>(count, len - offset);
+            const usize start = align_down(offset);
+#ifdef _WIN32
+            if (!FlushViewOfFile(ptr + start, count + (offset - start))) throw_last_error("FlushViewOfFile");
+            if (!FlushFileBuffers(file)) throw_last_error("FlushFileBuffers");
+#else
+            if (::msync(ptr + start, count + (offset - start), MS_SYNC) != 0) throw_last_error("msync");
+#endif
+        }
+
+        /// best-effort hint, unsupported hints are ignored
+        auto advise(const access_hint hint, const usize offset = 0, usize count = static_cast<usize>(-1)) const noexcept -> void {
+            if (ptr == nullptr || offset >= len) return;
+            count = std::min<usize>(count, len - offset);
+            const usize start = align_down(offset);
+#ifdef _WIN32
+            if (hint == access_hint::WillNeed) {
+                WIN32_MEMORY_RANGE_ENTRY range{ptr + start, count + (offset - start)};
+                PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+            }
+#else
+            int advice = MADV_NORMAL;
+            switch (hint) {
+                case access_hint::Sequential: advice = MADV_SEQUENTIAL; break;
+                case access_hint::Random: advice = MADV_RANDOM; break;
+                case access_hint::WillNeed: advice = MADV_WILLNEED; break;
+                case access_hint::DontNeed: advice = MADV_DONTNEED; break;
+                default: break;
+            }
+            ::madvise(ptr + start, count + (offset - start), advice);
+#endif
+        }
+
+        auto close() noexcept -> void {
+            unmap();
+#ifdef _WIN32
+            if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+            file = INVALID_HANDLE_VALUE;
+#else
+            if (fd >= 0) ::close(fd);
+            fd = -1;
+#endif
+            len = 0;
+        }
+
+    private:
+        u8* ptr = nullptr;
+        usize len = 0;
+        map_mode mode = map_mode::ReadOnly;
+#ifdef _WIN32
+        HANDLE file = INVALID_HANDLE_VALUE;
+        HANDLE mapping = nullptr;
+#else
+        int fd = -1;
+#endif
+
+        [[noreturn]] static auto throw_last_error(const char* what) -> void {
+#ifdef _WIN32
+            throw std::system_error(static_cast<int>(GetLastError()), std::system_category(), what);
+#else
+            throw std::system_error(errno, std::generic_category(), what);
+#endif
+        }
+        [[nodiscard]] static auto align_down(const usize offset) noexcept -> usize {
+#ifdef _WIN32
+            SYSTEM_INFO info;
+            GetSystemInfo(&info);
+            const usize page = info.dwPageSize;
+#else
+            static const usize page = static_cast<usize>(::sysconf(_SC_PAGESIZE));
+#endif
+            return offset - offset % page;
+        }
+
+        auto map() -> void {
+            // empty files cannot be mapped, `data()` stays null until the first resize
+            if (len == 0) return;
+            const bool rw = mode == map_mode::ReadWrite;
+#ifdef _WIN32
+            mapping = CreateFileMappingA(file, nullptr, rw ? PAGE_READWRITE : PAGE_READONLY, 0, 0, nullptr);
+            if (mapping == nullptr) throw_last_error("CreateFileMappingA");
+            ptr = static_cast<u8*>(MapViewOfFile(mapping, rw ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, len));
+            if (ptr == nullptr) {
+                CloseHandle(mapping);
+                mapping = nullptr;
+                throw_last_error("MapViewOfFile");
+            }
+#else
+            void* p = ::mmap(nullptr, len, PROT_READ | (rw ? PROT_WRITE : 0), MAP_SHARED, fd, 0);
+            if (p == MAP_FAILED) throw_last_error("mmap");
+            ptr = static_cast<u8*>(p);
+#endif
+        }
+        auto unmap() noexcept -> void {
+#ifdef _WIN32
+            if (ptr != nullptr) UnmapViewOfFile(ptr);
+            if (mapping != nullptr) CloseHandle(mapping);
+            mapping = nullptr;
+#else
+            if (ptr != nullptr) ::munmap(ptr, len);
+#endif
+            ptr = nullptr;
+        }
+        auto swap(mapped_file& other) noexcept -> void {
+            std::swap(ptr, other.ptr);
+            std::swap(len, other.len);
+            std::swap(mode, other.mode);
+#ifdef _WIN32
+            std::swap(file, other.file);
+            std::swap(mapping, other.mapping);
+#else
+            std::swap(fd, other.fd);
+#endif
+        }
+    };
+}
@@ -1,7 +1,11 @@
 #pragma once
 #include <string>
+#include <type_traits>
 namespace orc::core::concepts {
     template<typename T>
     concept tostring = std::convertible_to<T, std::string> ||
         requires (T a) { { std::to_string(a) } -> std::convertible_to<std::string>; };
+
+    template<typename T>
+    concept integer = std::is_integral_v<T> && !std::is_same_v<T, bool>;
 }
@@ -3,6 +3,14 @@
 #define repeat(n, body) \
     for (usize _ = 0; _ < n; _++) body
 
+#if defined(_MSC_VER) && !defined(__clang__)
+#define ORC_COLD __declspec(noinline)
+#define ORC_NOINLINE __declspec(noinline)
+#else
+#define ORC_COLD [[gnu::cold, gnu::noinline]]
+#define ORC_NOINLINE [[gnu::noinline]]
+#endif
+
 namespace orc::core::defines {
     using u8 = unsigned char;
     using u16 = unsigned short;
@@ -1,5 +1,6 @@
 #pragma once
 #include <orc_export.hpp>
+#include <ordefs.hpp>
 #include <stdexcept>
 
 #include <rstring.hpp>
@@ -44,11 +45,15 @@ namespace orc::expected {
             return *this;
         }
 
-        [[nodiscard]] auto unwrap() const -> T {
-            if (state) throw std::runtime_error("cannot unwrap `err` value");
+        [[nodiscard]] constexpr auto unwrap() const -> T {
+            if (state) [[unlikely]] throw std::runtime_error("cannot unwrap `err` value");
             return std::move(value);
         }
-        [[nodiscard]] auto unwrap_or(T&& def) const noexcept -> T {
+        [[nodiscard]] constexpr auto unwrap_move() -> T {
+            if (state) [[unlikely]] throw std::runtime_error("cannot unwrap `err` value");
+            return std::move(value);
+        }
+        [[nodiscard]] constexpr auto unwrap_or(T&& def) const noexcept -> T {
             if (state) return std::move(def);
             return std::move(value);
         }
@@ -70,7 +75,14 @@ namespace orc::expected {
             return std::move(value);
         }
 
-        [[nodiscard]] auto get_err() const -> E&& {
+        [[nodiscard]] constexpr auto get_ok() const -> const T& {
+            if (state) [[unlikely]] throw std::runtime_error("cannot get `ok` value of `err`");
+            return value;
+        }
+        [[nodiscard]] constexpr auto get_err() const -> const E& {
+            return err;
+        }
+        [[nodiscard]] constexpr auto get_err() -> E&& {
             return std::move(err);
         }
 
@@ -91,4 +103,23 @@ namespace orc::expected {
     ORC_API constexpr auto err(E&& e) noexcept -> _err_t<E> {
         return { std::forward<E>(e) };
     }
+    /// same as `err`, but kept out of line so the error branch is laid out as cold code
+    template<typename E>
+    ORC_COLD ORC_API constexpr auto cold_err(E e) noexcept -> _err_t<E> {
+        return { std::move(e) };
+    }
+
+    /// unwraps `expr` into `varname` or returns its error from the enclosing function
+    #define ORC_TRY(varname, expr)                                                  \
+    auto varname##_result = (expr);                                                 \
+    if (varname##_result.is_err()) [[unlikely]]                                     \
+        return ::orc::expected::cold_err(varname##_result.get_err());               \
+    auto varname = varname##_result.unwrap_move();
+
+    /// unwraps optional-like `expr` into `varname` or returns `error` from the enclosing function
+    #define ORC_TRY_SOME(varname, expr, error)                                      \
+    auto varname##_result = (expr);                                                 \
+    if (!varname##_result) [[unlikely]]                                             \
+        return ::orc::expected::cold_err(error);                                    \
+    auto varname = *std::move(varname##_result);
 }
@@ -1,13 +1,286 @@
 #pragma once
+#include <compare>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
 #include <orc_export.hpp>
 #include <ordefs.hpp>
 
+#include "arithmetic.hpp"
+#include "divisor.hpp"
+#include "expected.hpp"
+#include "format.hpp"
+#include "hash.hpp"
+
 using namespace orc::core::defines;
 
 namespace orc::floating {
-    struct rfloat {
-        unsigned long long sign : 1;
-        unsigned long long mantissa : 15;
-        unsigned long long num : 48;
+
+    enum class ORC_API rounding {
+        HalfEven,
+        HalfUp,
+        TowardZero,
+        Floor,
+        Ceil,
+    };
+
+    enum class ORC_API rfloat_error {
+        ParseError,
+        RangeError,
+    };
+
+    /// sign of `r - (d - r)`, i.e. how a remainder `r` of division by `d` compares to one half
+    [[nodiscard]] constexpr auto _compare_half(const u64 r, const u64 d) noexcept -> i32 {
+        const u64 rest = d - r;
+        return r > rest ? 1 : r == rest ? 0 : -1;
+    }
+    /// whether a truncated magnitude has to be incremented under `mode`
+    [[nodiscard]] constexpr auto _round_up(const rounding mode, const bool negative, const bool odd,
+                                           const i32 half_cmp, const bool inexact) noexcept -> u64 {
+        switch (mode) {
+            case rounding::HalfEven: return half_cmp > 0 || (half_cmp == 0 && odd);
+            case rounding::HalfUp: return half_cmp >= 0;
+            case rounding::Floor: return negative && inexact;
+            case rounding::Ceil: return !negative && inexact;
+            default: return 0;
+        }
+    }
+
+    /// exact decimal fixed-point number: sign, 48-bit integer part (`num`) and
+    /// `FRACTION_DIGITS` decimal digits of fraction (`mantissa`), stored as one scaled i64
+    class ORC_API rfloat {
+    public:
+        static constexpr u32 FRACTION_DIGITS = 4;
+        static constexpr i64 SCALE = 10000;
+        static constexpr u64 MAX_NUM = (1ull << 48) - 1;
+        static constexpr i64 MAX_RAW = static_cast<i64>(MAX_NUM) * SCALE + (SCALE - 1);
+
+        constexpr rfloat() noexcept = default;
+
+        /// `raw` is the value multiplied by `SCALE`
+        [[nodiscard]] static constexpr auto from_raw(const i64 raw) -> rfloat {
+            if (!in_range(raw)) [[unlikely]] throw std::out_of_range("rfloat out of range");
+            return rfloat{raw, 0};
+        }
+        [[nodiscard]] static constexpr auto from_parts(const bool sign, const u64 num, const u16 mantissa) -> rfloat {
+            if (num > MAX_NUM || mantissa >= SCALE) [[unlikely]] throw std::out_of_range("rfloat out of range");
+            const i64 magnitude = static_cast<i64>(num) * SCALE + mantissa;
+            return rfloat{sign ? -magnitude : magnitude, 0};
+        }
+        [[nodiscard]] static constexpr auto from_int(const i64 value) noexcept -> std::optional<rfloat> {
+            const auto raw = utils::arithmetic::checked_mul(value, SCALE);
+            if (!raw || !in_range(*raw)) [[unlikely]] return std::nullopt;
+            return rfloat{*raw, 0};
+        }
+        [[nodiscard]] static constexpr auto from_double(const double value, const rounding mode = rounding::HalfEven) noexcept -> std::optional<rfloat> {
+            if (!(value > -static_cast<double>(MAX_RAW + 1) / SCALE && value < static_cast<double>(MAX_RAW + 1) / SCALE)) [[unlikely]]
+                return std::nullopt;
+            const bool negative = value < 0;
+            const double scaled = (negative ? -value : value) * SCALE;
+            u64 q = static_cast<u64>(scaled);
+            const double frac = scaled - static_cast<double>(q);
+            const i32 half_cmp = frac > 0.5 ? 1 : frac == 0.5 ? 0 : -1;
+            q += _round_up(mode, negative, q & 1, half_cmp, frac != 0);
+            if (q > static_cast<u64>(MAX_RAW)) [[unlikely]] return std::nullopt;
+            return rfloat{negative ? -static_cast<i64>(q) : static_cast<i64>(q), 0};
+        }
+        /// parses `[+-]digits[.digits]`, extra fraction digits are rounded with `mode`
+        [[nodiscard]] static constexpr auto parse(const std::string_view str, const rounding mode = rounding::HalfEven) -> ::orc::expected::expected<rfloat, rfloat_error> {
+            using namespace orc::expected;
+            usize i = 0;
+            bool negative = false;
+            if (i < str.size() && (str[i] == '-' || str[i] == '+')) negative = str[i++] == '-';
+            const usize int_start = i;
+            u64 num = 0;
+            for (; i < str.size() && is_digit(str[i]); ++i) {
+                num = num * 10 + static_cast<u64>(str[i] - '0');
+                if (num > MAX_NUM) [[unlikely]] return cold_err(rfloat_error::RangeError);
+            }
+            const bool has_int = i != int_start;
+            u64 frac = 0;
+            u32 frac_digits = 0;
+            i32 first_dropped = 0;
+            bool sticky = false;
+            bool has_frac = false;
+            if (i < str.size() && str[i] == '.') {
+                for (++i; i < str.size() && is_digit(str[i]); ++i) {
+                    has_frac = true;
+                    const i32 digit = str[i] - '0';
+                    if (frac_digits < FRACTION_DIGITS) {
+                        frac = frac * 10 + static_cast<u64>(digit);
+                        frac_digits++;
+                    } else if (frac_digits == FRACTION_DIGITS) {
+                        first_dropped = digit;
+                        frac_digits++;
+                    } else {
+                        sticky |= digit != 0;
+                    }
+                }
+            }
+            if (i != str.size() || (!has_int && !has_frac)) [[unlikely]] return cold_err(rfloat_error::ParseError);
+            for (; frac_digits < FRACTION_DIGITS; ++frac_digits) frac *= 10;
+            u64 q = num * SCALE + frac;
+            const i32 half_cmp = first_dropped > 5 || (first_dropped == 5 && sticky) ? 1 : first_dropped == 5 ? 0 : -1;
+            q += _round_up(mode, negative, q & 1, half_cmp, first_dropped != 0 || sticky);
+            if (q > static_cast<u64>(MAX_RAW)) [[unlikely]] return cold_err(rfloat_error::RangeError);
+            return ok(rfloat{negative ? -static_cast<i64>(q) : static_cast<i64>(q), 0});
+        }
+
+        [[nodiscard]] constexpr auto raw() const noexcept -> i64 { return value; }
+        [[nodiscard]] constexpr auto sign() const noexcept -> bool { return value < 0; }
+        [[nodiscard]] constexpr auto num() const noexcept -> u64 { return magnitude() / SCALE; }
+        [[nodiscard]] constexpr auto mantissa() const noexcept -> u16 { return static_cast<u16>(magnitude() % SCALE); }
+
+        [[nodiscard]] constexpr auto to_double() const noexcept -> double { return static_cast<double>(value) / SCALE; }
+        [[nodiscard]] constexpr auto to_string() const -> std::string {
+            char buf[32];
+            const usize len = write_digits(buf);
+            return std::string(buf + sizeof(buf) - len, len);
+        }
+
+        [[nodiscard]] constexpr auto overflowing_add(const rfloat rhs) const noexcept -> std::pair<rfloat, bool> {
+            // both operands are far below i64 limits, so only the rfloat range has to be checked
+            const i64 res = value + rhs.value;
+            return std::make_pair(rfloat{res, 0}, !in_range(res));
+        }
+        [[nodiscard]] constexpr auto overflowing_sub(const rfloat rhs) const noexcept -> std::pair<rfloat, bool> {
+            const i64 res = value - rhs.value;
+            return std::make_pair(rfloat{res, 0}, !in_range(res));
+        }
+        [[nodiscard]] constexpr auto overflowing_mul(const rfloat rhs, const rounding mode = rounding::HalfEven) const noexcept -> std::pair<rfloat, bool> {
+            // |a * b| / SCALE = ai*bi*SCALE + ai*bf + af*bi + af*bf / SCALE, only the last term is inexact
+            const bool negative = (value < 0) != (rhs.value < 0);
+            const u64 a = magnitude(), b = rhs.magnitude();
+            const u64 ai = a / SCALE, af = a % SCALE, bi = b / SCALE, bf = b % SCALE;
+            const auto [ints, ints_overflow] = utils::arithmetic::mul_with_overflow(ai, bi);
+            const u64 whole = ints * SCALE;
+            const u64 cross = ai * bf + af * bi;
+            const u64 low = af * bf;
+            u64 q = low / SCALE;
+            const u64 r = low % SCALE;
+            q += _round_up(mode, negative, (q + cross + whole) & 1, _compare_half(r, SCALE), r != 0);
+            const auto [sum, sum_overflow] = utils::arithmetic::add_with_overflow(whole, cross + q);
+            const bool overflow = ints_overflow || ints > MAX_NUM || sum_overflow || sum > static_cast<u64>(MAX_RAW);
+            const i64 res = static_cast<i64>(sum);
+            return std::make_pair(rfloat{negative ? -res : res, 0}, overflow);
+        }
+        /// overflows on division by zero as well
+        [[nodiscard]] constexpr auto overflowing_div(const rfloat rhs, const rounding mode = rounding::HalfEven) const noexcept -> std::pair<rfloat, bool> {
+            if (rhs.value == 0) [[unlikely]] return std::make_pair(rfloat{}, true);
+            const bool negative = (value < 0) != (rhs.value < 0);
+            const u64 a = magnitude(), b = rhs.magnitude();
+            // 128-bit a * SCALE, the quotient fits into 64 bits whenever the high half is below b
+            const u64 high = utils::arithmetic::mul_high(a, SCALE);
+            const u64 low = a * SCALE;
+            if (high >= b) [[unlikely]] return std::make_pair(rfloat{}, true);
+            u64 q = utils::arithmetic::_div_128_by_64(high, low, b);
+            const u64 r = low - q * b;
+            q += _round_up(mode, negative, q & 1, _compare_half(r, b), r != 0);
+            const i64 res = static_cast<i64>(q);
+            return std::make_pair(rfloat{negative ? -res : res, 0}, q > static_cast<u64>(MAX_RAW));
+        }
+
+        [[nodiscard]] constexpr auto checked_add(const rfloat rhs) const noexcept -> std::optional<rfloat> {
+            return from_overflowing(overflowing_add(rhs));
+        }
+        [[nodiscard]] constexpr auto checked_sub(const rfloat rhs) const noexcept -> std::optional<rfloat> {
+            return from_overflowing(overflowing_sub(rhs));
+        }
+        [[nodiscard]] constexpr auto checked_mul(const rfloat rhs, const rounding mode = rounding::HalfEven) const noexcept -> std::optional<rfloat> {
+            return from_overflowing(overflowing_mul(rhs, mode));
+        }
+        [[nodiscard]] constexpr auto checked_div(const rfloat rhs, const rounding mode = rounding::HalfEven) const noexcept -> std::optional<rfloat> {
+            return from_overflowing(overflowing_div(rhs, mode));
+        }
+
+        [[nodiscard]] constexpr auto abs() const noexcept -> rfloat { return rfloat{value < 0 ? -value : value, 0}; }
+        [[nodiscard]] constexpr auto operator-() const noexcept -> rfloat { return rfloat{-value, 0}; }
+
+        [[nodiscard]] constexpr auto operator+(const rfloat rhs) const -> rfloat { return unwrap_overflow(overflowing_add(rhs)); }
+        [[nodiscard]] constexpr auto operator-(const rfloat rhs) const -> rfloat { return unwrap_overflow(overflowing_sub(rhs)); }
+        [[nodiscard]] constexpr auto operator*(const rfloat rhs) const -> rfloat { return unwrap_overflow(overflowing_mul(rhs)); }
+        [[nodiscard]] constexpr auto operator/(const rfloat rhs) const -> rfloat {
+            if (rhs.value == 0) [[unlikely]] throw std::domain_error("rfloat division by zero");
+            return unwrap_overflow(overflowing_div(rhs));
+        }
+        constexpr auto operator+=(const rfloat rhs) -> rfloat& { return *this = *this + rhs; }
+        constexpr auto operator-=(const rfloat rhs) -> rfloat& { return *this = *this - rhs; }
+        constexpr auto operator*=(const rfloat rhs) -> rfloat& { return *this = *this * rhs; }
+        constexpr auto operator/=(const rfloat rhs) -> rfloat& { return *this = *this / rhs; }
+
+        [[nodiscard]] constexpr auto operator<=>(const rfloat&) const noexcept -> std::strong_ordering = default;
+        [[nodiscard]] constexpr auto operator==(const rfloat&) const noexcept -> bool = default;
+        auto hash(hash::hasher& state) const noexcept -> void { state.write(value); }
+
+        auto format_to(format::sink& out) const -> void {
+            char buf[32];
+            const usize len = write_digits(buf);
+            out.write({buf + sizeof(buf) - len, len});
+        }
+        friend auto operator<<(std::ostream& os, const rfloat& f) -> std::ostream& {
+            os << f.to_string();
+            return os;
+        }
+
+    private:
+        i64 value = 0;
+
+        constexpr rfloat(const i64 raw, int) noexcept : value(raw) {}
+
+        [[nodiscard]] static constexpr auto in_range(const i64 raw) noexcept -> bool {
+            return static_cast<u64>(raw) + static_cast<u64>(MAX_RAW) <= static_cast<u64>(2 * MAX_RAW);
+        }
+        /// fills the tail of `buf` with the decimal text, returns its length
+        constexpr auto write_digits(char (&buf)[32]) const noexcept -> usize {
+            usize pos = sizeof(buf);
+            u64 m = magnitude();
+            for (u32 d = 0; d < FRACTION_DIGITS; ++d, m /= 10) buf[--pos] = static_cast<char>('0' + m % 10);
+            buf[--pos] = '.';
+            do { buf[--pos] = static_cast<char>('0' + m % 10); m /= 10; } while (m != 0);
+            if (value < 0) buf[--pos] = '-';
+            return sizeof(buf) - pos;
+        }
+        [[nodiscard]] static constexpr auto is_digit(const char ch) noexcept -> bool { return ch >= '0' && ch <= '9'; }
+        [[nodiscard]] constexpr auto magnitude() const noexcept -> u64 {
+            return value < 0 ? 0 - static_cast<u64>(value) : static_cast<u64>(value);
+        }
+        [[nodiscard]] static constexpr auto from_overflowing(const std::pair<rfloat, bool> res) noexcept -> std::optional<rfloat> {
+            if (res.second) [[unlikely]] return std::nullopt;
+            return res.first;
+        }
+        [[nodiscard]] static constexpr auto unwrap_overflow(const std::pair<rfloat, bool> res) -> rfloat {
+            if (res.second) [[unlikely]] throw std::overflow_error("rfloat overflow");
+            return res.first;
+        }
     };
-}
\ No newline at end of file
+
+    ORC_API constexpr rfloat RFLOAT_MAX = rfloat::from_raw(rfloat::MAX_RAW);
+    ORC_API constexpr rfloat RFLOAT_MIN = rfloat::from_raw(-rfloat::MAX_RAW);
+}
+
+namespace orc::utils::arithmetic {
+    ORC_API constexpr auto add_with_overflow(const floating::rfloat left, const floating::rfloat right) noexcept -> std::pair<floating::rfloat, bool> {
+        return left.overflowing_add(right);
+    }
+    ORC_API constexpr auto sub_with_overflow(const floating::rfloat left, const floating::rfloat right) noexcept -> std::pair<floating::rfloat, bool> {
+        return left.overflowing_sub(right);
+    }
+    ORC_API constexpr auto mul_with_overflow(const floating::rfloat left, const floating::rfloat right) noexcept -> std::pair<floating::rfloat, bool> {
+        return left.overflowing_mul(right);
+    }
+    ORC_API constexpr auto checked_add(const floating::rfloat left, const floating::rfloat right) noexcept -> std::optional<floating::rfloat> {
+        return left.checked_add(right);
+    }
+    ORC_API constexpr auto checked_sub(const floating::rfloat left, const floating::rfloat right) noexcept -> std::optional<floating::rfloat> {
+        return left.checked_sub(right);
+    }
+    ORC_API constexpr auto checked_mul(const floating::rfloat left, const floating::rfloat right) noexcept -> std::optional<floating::rfloat> {
+        return left.checked_mul(right);
+    }
+    ORC_API constexpr auto checked_div(const floating::rfloat left, const floating::rfloat right) noexcept -> std::optional<floating::rfloat> {
+        return left.checked_div(right);
+    }
+}
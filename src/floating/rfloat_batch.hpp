@@ -0,0 +1,261 @@
+#pragma once
+#include <bit>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <orc_export.hpp>
+#include <ordefs.hpp>
+
+#include "arithmetic.hpp"
+#include "cmp.hpp"
+#include "divisor.hpp"
+#include "rfloat.hpp"
+
+#if defined(__AVX2__) || defined(__SSE4_2__)
+#include <immintrin.h>
+#endif
+
+using namespace orc::core::defines;
+
+namespace orc::floating {
+    // rfloat is a single standard-layout i64, so a column of them has the layout of an i64 column.
+    // the vector kernels load whole lanes from it, scalar code goes through `rfloat::raw`
+    static_assert(sizeof(rfloat) == sizeof(i64) && alignof(rfloat) == alignof(i64) && std::is_standard_layout_v<rfloat> && std::is_trivially_copyable_v<rfloat>,
+                  "batch kernels treat rfloat columns as i64 columns");
+
+    /// scaled values of `values`, see `rfloat::raw`. relies on the layout asserted above
+    ORC_API inline auto raw_span(const std::span<const rfloat> values) noexcept -> std::span<const i64> {
+        return { reinterpret_cast<const i64*>(values.data()), values.size() };
+    }
+
+    /// exact sum of the column, `nullopt` when it does not fit into rfloat
+    ORC_API inline auto sum(const std::span<const rfloat> values) -> std::optional<rfloat> {
+        const auto total = utils::arithmetic::checked_sum(raw_span(values));
+        if (!total || *total > rfloat::MAX_RAW || *total < -rfloat::MAX_RAW) [[unlikely]] return std::nullopt;
+        return rfloat::from_raw(*total);
+    }
+
+    /// sum of `left[i] * right[i]`, accumulated exactly in 128 bits and rounded once at the end
+    ORC_API constexpr auto dot(const std::span<const rfloat> left, const std::span<const rfloat> right, const rounding mode = rounding::HalfEven) -> std::optional<rfloat> {
+        if (left.size() != right.size()) throw std::invalid_argument("span sizes do not match");
+        const usize n = left.size();
+        u64 acc_hi = 0, acc_lo = 0;
+        i64 wraps = 0;
+        usize i = 0;
+#if defined(__AVX2__)
+        if (!std::is_constant_evaluated()) {
+            // |raw| < 2^62, so every product splits into four 32x32 partial products. their 32-bit halves are
+            // summed by weight (2^0, 2^32, 2^64, 2^96) in signed lanes, each row adds less than 2^34 to a lane
+            constexpr usize BLOCK = usize{1} << 30;
+            const __m256i zero = _mm256_setzero_si256();
+            const __m256i low = _mm256_set1_epi64x(0xFFFFFFFF);
+            // exact 192-bit sum of the folded lanes
+            u64 limbs[3] = {};
+            const auto fold = [&limbs](const __m256i lanes, const u32 shift) {
+                alignas(32) i64 values[4];
+                _mm256_store_si256(reinterpret_cast<__m256i*>(values), lanes);
+                for (const i64 v : values) {
+                    const u64 ext = v < 0 ? ~u64{0} : 0;
+                    u64 part[3] = {static_cast<u64>(v), ext, ext};
+                    for (u32 s = 0; s < shift; s += 32) {
+                        part[2] = (part[2] << 32) | (part[1] >> 32);
+                        part[1] = (part[1] << 32) | (part[0] >> 32);
+                        part[0] <<= 32;
+                    }
+                    u64 carry = 0;
+                    for (usize k = 0; k < 3; ++k) {
+                        const u64 sum = limbs[k] + part[k];
+                        const u64 next = sum < part[k];
+                        limbs[k] = sum + carry;
+                        carry = next | (limbs[k] < sum);
+                    }
+                }
+            };
+            while (n - i >= 4) {
+                __m256i acc[4] = {zero, zero, zero, zero};
+                const usize end = i + std::min<usize>(BLOCK, (n - i) & ~usize{3});
+                for (; i < end; i += 4) {
+                    const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(left.data() + i));
+                    const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(right.data() + i));
+                    const __m256i sign_a = _mm256_cmpgt_epi64(zero, a), sign_b = _mm256_cmpgt_epi64(zero, b);
+                    const __m256i abs_a = _mm256_sub_epi64(_mm256_xor_si256(a, sign_a), sign_a);
+                    const __m256i abs_b = _mm256_sub_epi64(_mm256_xor_si256(b, sign_b), sign_b);
+                    const __m256i negative = _mm256_xor_si256(sign_a, sign_b);
+                    const __m256i high_a = _mm256_srli_epi64(abs_a, 32), high_b = _mm256_srli_epi64(abs_b, 32);
+                    const __m256i p00 = _mm256_mul_epu32(abs_a, abs_b);
+                    const __m256i p01 = _mm256_mul_epu32(abs_a, high_b);
+                    const __m256i p10 = _mm256_mul_epu32(high_a, abs_b);
+                    const __m256i p11 = _mm256_mul_epu32(high_a, high_b);
+                    const __m256i parts[4] = {
+                        _mm256_and_si256(p00, low),
+                        _mm256_add_epi64(_mm256_srli_epi64(p00, 32), _mm256_add_epi64(_mm256_and_si256(p01, low), _mm256_and_si256(p10, low))),
+                        _mm256_add_epi64(_mm256_and_si256(p11, low), _mm256_add_epi64(_mm256_srli_epi64(p01, 32), _mm256_srli_epi64(p10, 32))),
+                        _mm256_srli_epi64(p11, 32),
+                    };
+                    for (usize k = 0; k < 4; ++k)
+                        acc[k] = _mm256_add_epi64(acc[k], _mm256_sub_epi64(_mm256_xor_si256(parts[k], negative), negative));
+                }
+                for (u32 k = 0; k < 4; ++k) fold(acc[k], 32 * k);
+            }
+            // the same 128-bit state the scalar loop keeps, the top limb counts the wraps
+            acc_lo = limbs[0];
+            acc_hi = limbs[1];
+            wraps = static_cast<i64>(limbs[2]) + static_cast<i64>(limbs[1] >> 63);
+        }
+#endif
+        for (; i < n; ++i) {
+            const i64 a = left[i].raw(), b = right[i].raw();
+            const u64 abs_a = a < 0 ? 0 - static_cast<u64>(a) : static_cast<u64>(a);
+            const u64 abs_b = b < 0 ? 0 - static_cast<u64>(b) : static_cast<u64>(b);
+            u64 p_hi = utils::arithmetic::mul_high(abs_a, abs_b);
+            u64 p_lo = abs_a * abs_b;
+            if ((a < 0) != (b < 0)) {
+                p_lo = 0 - p_lo;
+                p_hi = ~p_hi + (p_lo == 0);
+            }
+            const u64 lo = acc_lo + p_lo;
+            const u64 hi = acc_hi + p_hi + (lo < acc_lo);
+            // signed 128-bit overflow, counted like in `checked_sum` so only the final value matters
+            if (static_cast<i64>((acc_hi ^ hi) & (p_hi ^ hi)) < 0) [[unlikely]]
+                wraps += static_cast<i64>(p_hi) < 0 ? -1 : 1;
+            acc_hi = hi;
+            acc_lo = lo;
+        }
+        if (wraps != 0) [[unlikely]] return std::nullopt;
+        const bool negative = static_cast<i64>(acc_hi) < 0;
+        if (negative) {
+            acc_lo = 0 - acc_lo;
+            acc_hi = ~acc_hi + (acc_lo == 0);
+        }
+        if (acc_hi >= static_cast<u64>(rfloat::SCALE)) [[unlikely]] return std::nullopt;
+        u64 q = utils::arithmetic::_div_128_by_64(acc_hi, acc_lo, rfloat::SCALE);
+        const u64 r = acc_lo - q * rfloat::SCALE;
+        q += _round_up(mode, negative, q & 1, _compare_half(r, rfloat::SCALE), r != 0);
+        if (q > static_cast<u64>(rfloat::MAX_RAW)) [[unlikely]] return std::nullopt;
+        return rfloat::from_raw(negative ? -static_cast<i64>(q) : static_cast<i64>(q));
+    }
+
+    /// `out[i] = values[i] * factor`, returns the index of the first overflowing element or `values.size()`.
+    /// whole factors are vectorized, fractional ones round every element through a division by `SCALE` and stay scalar
+    ORC_API constexpr auto scale(const std::span<const rfloat> values, const rfloat factor, const std::span<rfloat> out, const rounding mode = rounding::HalfEven) -> usize {
+        if (out.size() < values.size()) throw std::invalid_argument("span sizes do not match");
+        if (factor.mantissa() == 0) {
+            // whole factors need no rounding, a single checked multiply of the scaled value is enough
+            const i64 k = factor.sign() ? -static_cast<i64>(factor.num()) : static_cast<i64>(factor.num());
+            usize i = 0;
+#if defined(__AVX2__)
+            if (!std::is_constant_evaluated()) {
+                // |raw| < 2^62 and |k| < 2^48, so |raw * k| is built from three 32x32 products. a block with an
+                // overflow is left to the scalar loop, which finds the first overflowing element in it
+                const __m256i zero = _mm256_setzero_si256();
+                const __m256i max_raw = _mm256_set1_epi64x(rfloat::MAX_RAW);
+                const __m256i max_mid = _mm256_set1_epi64x(rfloat::MAX_RAW >> 32);
+                const u64 abs_k = factor.num();
+                const __m256i k_low = _mm256_set1_epi64x(static_cast<i64>(abs_k & 0xFFFFFFFF));
+                const __m256i k_high = _mm256_set1_epi64x(static_cast<i64>(abs_k >> 32));
+                const __m256i sign_k = _mm256_set1_epi64x(factor.sign() ? -1 : 0);
+                for (; i + 4 <= values.size(); i += 4) {
+                    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values.data() + i));
+                    const __m256i sign_v = _mm256_cmpgt_epi64(zero, v);
+                    const __m256i abs_v = _mm256_sub_epi64(_mm256_xor_si256(v, sign_v), sign_v);
+                    const __m256i high_v = _mm256_srli_epi64(abs_v, 32);
+                    const __m256i mid = _mm256_add_epi64(_mm256_mul_epu32(high_v, k_low), _mm256_mul_epu32(abs_v, k_high));
+                    const __m256i top = _mm256_mul_epu32(high_v, k_high);
+                    const __m256i bottom = _mm256_mul_epu32(abs_v, k_low);
+                    const __m256i product = _mm256_add_epi64(bottom, _mm256_slli_epi64(mid, 32));
+                    // every term is checked against MAX_RAW < 2^62 before its sum could leave the signed range
+                    const __m256i overflow = _mm256_or_si256(
+                        _mm256_or_si256(_mm256_cmpgt_epi64(top, zero), _mm256_cmpgt_epi64(mid, max_mid)),
+                        _mm256_or_si256(_mm256_cmpgt_epi64(zero, bottom), _mm256_or_si256(_mm256_cmpgt_epi64(zero, product), _mm256_cmpgt_epi64(product, max_raw))));
+                    if (!_mm256_testz_si256(overflow, overflow)) [[unlikely]] break;
+                    const __m256i negative = _mm256_xor_si256(sign_v, sign_k);
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out.data() + i), _mm256_sub_epi64(_mm256_xor_si256(product, negative), negative));
+                }
+            }
+#endif
+            for (; i < values.size(); ++i) {
+                const auto [res, overflow] = utils::arithmetic::mul_with_overflow(values[i].raw(), k);
+                if (overflow || res > rfloat::MAX_RAW || res < -rfloat::MAX_RAW) [[unlikely]] return i;
+                out[i] = rfloat::from_raw(res);
+            }
+            return values.size();
+        }
+        for (usize i = 0; i < values.size(); ++i) {
+            const auto [res, overflow] = values[i].overflowing_mul(factor, mode);
+            if (overflow) [[unlikely]] return i;
+            out[i] = res;
+        }
+        return values.size();
+    }
+
+    /// sets bit `i % 64` of `mask[i / 64]` when `cmp(values[i], threshold) == ord`, returns the number of set bits
+    ORC_API inline auto compare(const std::span<const rfloat> values, const rfloat threshold, const utils::cmp::ordering ord, const std::span<u64> mask) -> usize {
+        using utils::cmp::ordering;
+        const usize n = values.size();
+        if (mask.size() < (n + 63) / 64) throw std::invalid_argument("mask is too small");
+#if defined(__AVX2__) || defined(__SSE4_2__)
+        const i64* raw = raw_span(values).data();
+#endif
+        const i64 t = threshold.raw();
+        usize count = 0;
+        for (usize base = 0; base < n; base += 64) {
+            const usize len = std::min<usize>(64, n - base);
+            u64 word = 0;
+            usize i = 0;
+#if defined(__AVX2__)
+            const __m256i tv = _mm256_set1_epi64x(t);
+            for (; i + 4 <= len; i += 4) {
+                const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(raw + base + i));
+                __m256i hit;
+                switch (ord) {
+                    case ordering::Less: hit = _mm256_cmpgt_epi64(tv, v); break;
+                    case ordering::Greater: hit = _mm256_cmpgt_epi64(v, tv); break;
+                    default: hit = _mm256_cmpeq_epi64(v, tv); break;
+                }
+                word |= static_cast<u64>(_mm256_movemask_pd(_mm256_castsi256_pd(hit))) << i;
+            }
+#elif defined(__SSE4_2__)
+            const __m128i tv = _mm_set1_epi64x(t);
+            for (; i + 2 <= len; i += 2) {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(raw + base + i));
+                __m128i hit;
+                switch (ord) {
+                    case ordering::Less: hit = _mm_cmpgt_epi64(tv, v); break;
+                    case ordering::Greater: hit = _mm_cmpgt_epi64(v, tv); break;
+                    default: hit = _mm_cmpeq_epi64(v, tv); break;
+                }
+                word |= static_cast<u64>(_mm_movemask_pd(_mm_castsi128_pd(hit))) << i;
+            }
+#endif
+            for (; i < len; ++i) {
+                const i64 v = values[base + i].raw();
+                bool hit;
+                switch (ord) {
+                    case ordering::Less: hit = v < t; break;
+                    case ordering::Greater: hit = v > t; break;
+                    default: hit = v == t; break;
+                }
+                word |= static_cast<u64>(hit) << i;
+            }
+            mask[base / 64] = word;
+            count += static_cast<usize>(std::popcount(word));
+        }
+        return count;
+    }
+
+    /// copies the elements selected by `mask` (as produced by `compare`) into `out`, returns how many were copied
+    ORC_API constexpr auto filter(const std::span<const rfloat> values, const std::span<const u64> mask, const std::span<rfloat> out) -> usize {
+        if (mask.size() < (values.size() + 63) / 64) throw std::invalid_argument("mask is too small");
+        usize written = 0;
+        for (usize w = 0; w < (values.size() + 63) / 64; ++w) {
+            for (u64 word = mask[w]; word != 0; word &= word - 1) {
+                const usize idx = w * 64 + static_cast<usize>(std::countr_zero(word));
+                if (idx >= values.size()) break;
+                if (written >= out.size()) [[unlikely]] throw std::out_of_range("output span is too small");
+                out[written++] = values[idx];
+            }
+        }
+        return written;
+    }
+}
@@ -0,0 +1,264 @@
+#pragma once
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <concepts>
+#include <cstring>
+#include <ostream>
+#include <span>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <orc_export.hpp>
+#include <ordefs.hpp>
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace orc::core::defines;
+
+namespace orc::format {
+
+    class sink;
+
+    /// types which write themselves into a `sink`
+    template<typename T>
+    concept formattable = requires(const T& value, sink& out) { value.format_to(out); };
+
+    /// buffered byte output. appends go to an inline buffer, full buffers are handed to `consume` in one piece.
+    /// a sink is not synchronized, share it between threads only with external locking
+    class ORC_API sink {
+    public:
+        static constexpr usize BUFFER_SIZE = 4096;
+
+        sink(const sink&) = delete;
+        auto operator=(const sink&) -> sink& = delete;
+        virtual ~sink() = default;
+
+        auto put(const char ch) -> void {
+            if (pos == BUFFER_SIZE) [[unlikely]] drain();
+            buffer[pos++] = ch;
+        }
+        auto write(const std::string_view str) -> void {
+            if (str.size() <= BUFFER_SIZE - pos) [[likely]] {
+                std::memcpy(buffer + pos, str.data(), str.size());
+                pos += str.size();
+                return;
+            }
+            write_slow(str);
+        }
+        auto write(const std::span<const u8> bytes) -> void { write({reinterpret_cast<const char*>(bytes.data()), bytes.size()}); }
+        /// `count` copies of `ch`
+        auto fill(const char ch, usize count) -> void {
+            while (count > 0) {
+                if (pos == BUFFER_SIZE) drain();
+                const usize n = std::min<usize>(count, BUFFER_SIZE - pos);
+                std::memset(buffer + pos, ch, n);
+                pos += n;
+                count -= n;
+            }
+        }
+        /// hands buffered bytes to the destination and asks it to push them further
+        auto flush() -> void {
+            drain();
+            sync();
+        }
+
+    protected:
+        sink() = default;
+        /// receives every byte exactly once, in order
+        virtual auto consume(std::string_view bytes) -> void = 0;
+        virtual auto sync() -> void {}
+
+    private:
+        char buffer[BUFFER_SIZE];
+        usize pos = 0;
+
+        auto drain() -> void {
+            if (pos == 0) return;
+            // reset first, a throwing destination must not see the same bytes twice
+            const usize n = pos;
+            pos = 0;
+            consume({buffer, n});
+        }
+        ORC_NOINLINE auto write_slow(const std::string_view str) -> void {
+            drain();
+            if (str.size() >= BUFFER_SIZE) {
+                consume(str);
+                return;
+            }
+            std::memcpy(buffer, str.data(), str.size());
+            pos = str.size();
+        }
+    };
+
+    /// collects output in a `std::string`
+    class ORC_API string_sink final : public sink {
+    public:
+        string_sink() = default;
+        ~string_sink() override = default;
+
+        [[nodiscard]] auto str() -> const std::string& {
+            flush();
+            return out;
+        }
+        [[nodiscard]] auto take() -> std::string {
+            flush();
+            return std::move(out);
+        }
+
+    protected:
+        auto consume(const std::string_view bytes) -> void override { out.append(bytes); }
+
+    private:
+        std::string out;
+    };
+
+    /// forwards to a `std::ostream` with one `write` per buffer instead of one per value
+    class ORC_API ostream_sink final : public sink {
+    public:
+        explicit ostream_sink(std::ostream& os) : os(os) {}
+        ~ostream_sink() override {
+            try { flush(); } catch (...) {}
+        }
+
+    protected:
+        auto consume(const std::string_view bytes) -> void override { os.write(bytes.data(), static_cast<std::streamsize>(bytes.size())); }
+        auto sync() -> void override { os.flush(); }
+
+    private:
+        std::ostream& os;
+    };
+
+    /// writes to a file descriptor, `std::system_error` on failure
+    class ORC_API fd_sink : public sink {
+    public:
+        explicit fd_sink(const int fd) noexcept : fd(fd) {}
+        ~fd_sink() override {
+            try { flush(); } catch (...) {}
+        }
+
+    protected:
+        int fd;
+
+        auto consume(std::string_view bytes) -> void override {
+            while (!bytes.empty()) {
+#ifdef _WIN32
+                const int written = ::_write(fd, bytes.data(), static_cast<unsigned>(std::min<usize>(bytes.size(), 1u << 30)));
+#else
+                const isize written = ::write(fd, bytes.data(), bytes.size());
+#endif
+                if (written < 0) {
+                    if (errno == EINTR) continue;
+                    throw std::system_error(errno, std::generic_category(), "write");
+                }
+                bytes.remove_prefix(static_cast<usize>(written));
+            }
+        }
+    };
+
+    /// creates or truncates `path` and writes to it
+    class ORC_API file_sink final : public fd_sink {
+    public:
+        explicit file_sink(const std::string& path) : fd_sink(open(path)) {}
+        ~file_sink() override {
+            try { flush(); } catch (...) {}
+#ifdef _WIN32
+            ::_close(fd);
+#else
+            ::close(fd);
+#endif
+        }
+
+    private:
+        [[nodiscard]] static auto open(const std::string& path) -> int {
+#ifdef _WIN32
+            const int fd = ::_open(path.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+            const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#endif
+            if (fd < 0) throw std::system_error(errno, std::generic_category(), "open");
+            return fd;
+        }
+    };
+
+    /// lets `operator<<` of foreign types write into a sink
+    class ORC_API _sink_streambuf final : public std::streambuf {
+    public:
+        explicit _sink_streambuf(sink& out) noexcept : out(out) {}
+
+    protected:
+        auto overflow(const int_type ch) -> int_type override {
+            if (!traits_type::eq_int_type(ch, traits_type::eof())) out.put(traits_type::to_char_type(ch));
+            return traits_type::not_eof(ch);
+        }
+        auto xsputn(const char* s, const std::streamsize n) -> std::streamsize override {
+            out.write({s, static_cast<usize>(n)});
+            return n;
+        }
+
+    private:
+        sink& out;
+    };
+
+    template<typename T>
+    concept _ostreamable = requires(std::ostream& os, const T& value) { os << value; };
+
+    /// writes `value` without going through iostreams when its type allows it
+    template<typename T>
+    ORC_API auto format_to(sink& out, const T& value) -> void {
+        if constexpr (formattable<T>) {
+            value.format_to(out);
+        } else if constexpr (std::is_same_v<T, bool>) {
+            out.put(value ? '1' : '0');
+        } else if constexpr (std::is_same_v<T, char> || std::is_same_v<T, signed char> || std::is_same_v<T, unsigned char>) {
+            // same as iostreams, bytes are characters
+            out.put(static_cast<char>(value));
+        } else if constexpr (std::is_integral_v<T>) {
+            char buf[24];
+            const auto res = std::to_chars(buf, buf + sizeof(buf), value);
+            out.write({buf, static_cast<usize>(res.ptr - buf)});
+        } else if constexpr (std::is_floating_point_v<T>) {
+            // same text as a default-configured stream (`%g`, 6 significant digits), a stream's own
+            // precision and flags are not seen here
+            char buf[64];
+            const auto res = std::to_chars(buf, buf + sizeof(buf), value, std::chars_format::general, 6);
+            out.write({buf, static_cast<usize>(res.ptr - buf)});
+        } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+            out.write(std::string_view(value));
+        } else {
+            static_assert(_ostreamable<T>, "type is neither formattable nor printable");
+            _sink_streambuf buf(out);
+            std::ostream os(&buf);
+            os << value;
+        }
+    }
+    /// zero-padded unsigned number with at least `width` digits
+    ORC_API inline auto format_padded(sink& out, u64 value, const u32 width) -> void {
+        char buf[20];
+        usize pos = sizeof(buf);
+        do { buf[--pos] = static_cast<char>('0' + value % 10); value /= 10; } while (value != 0);
+        if (sizeof(buf) - pos < width) out.fill('0', width - (sizeof(buf) - pos));
+        out.write({buf + pos, sizeof(buf) - pos});
+    }
+
+    template<typename T>
+    ORC_API auto operator<<(sink& out, const T& value) -> sink& {
+        format_to(out, value);
+        return out;
+    }
+
+    template<typename T>
+    [[nodiscard]] ORC_API auto to_string(const T& value) -> std::string {
+        string_sink out;
+        format_to(out, value);
+        return out.take();
+    }
+}
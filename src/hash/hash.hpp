@@ -0,0 +1,192 @@
+#pragma once
+#include <cstring>
+#include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <orc_export.hpp>
+#include <ordefs.hpp>
+#include <orconcepts.hpp>
+
+#include "divisor.hpp"
+
+using namespace orc::core::defines;
+
+namespace orc::hash {
+
+    class hasher;
+
+    /// types which feed themselves into a streaming `hasher`
+    template<typename T>
+    concept hashable = requires(const T& value, hasher& state) { value.hash(state); };
+
+    inline constexpr u64 _SECRET[4] = {
+        0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull,
+    };
+    inline constexpr usize _BLOCK = 48;
+
+    constexpr auto _mum(u64& a, u64& b) noexcept -> void {
+        const u64 high = utils::arithmetic::mul_high(a, b);
+        a *= b;
+        b = high;
+    }
+    [[nodiscard]] constexpr auto _mix(u64 a, u64 b) noexcept -> u64 {
+        _mum(a, b);
+        return a ^ b;
+    }
+    [[nodiscard]] inline auto _read64(const u8* p) noexcept -> u64 {
+        u64 v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+    [[nodiscard]] inline auto _read32(const u8* p) noexcept -> u64 {
+        u32 v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+    [[nodiscard]] constexpr auto _seed(const u64 seed) noexcept -> u64 { return seed ^ _mix(seed ^ _SECRET[0], _SECRET[1]); }
+
+    inline auto _block(const u8* p, u64& s0, u64& s1, u64& s2) noexcept -> void {
+        s0 = _mix(_read64(p) ^ _SECRET[1], _read64(p + 8) ^ s0);
+        s1 = _mix(_read64(p + 16) ^ _SECRET[2], _read64(p + 24) ^ s1);
+        s2 = _mix(_read64(p + 32) ^ _SECRET[3], _read64(p + 40) ^ s2);
+    }
+
+    /// consumes the last `n <= 48` bytes, the three lanes are folded first
+    [[nodiscard]] inline auto _finish(const u8* p, usize n, const u64 total, const u64 s0, const u64 s1, const u64 s2) noexcept -> u64 {
+        u64 seed = s0 ^ s1 ^ s2;
+        for (; n > 16; p += 16, n -= 16)
+            seed = _mix(_read64(p) ^ _SECRET[1], _read64(p + 8) ^ seed);
+        u64 a = 0, b = 0;
+        if (n >= 4) {
+            // overlapping reads cover 4..16 bytes without branching on the exact length
+            const usize mid = (n >> 3) << 2;
+            a = (_read32(p) << 32) | _read32(p + mid);
+            b = (_read32(p + n - 4) << 32) | _read32(p + n - 4 - mid);
+        } else if (n > 0) {
+            a = (static_cast<u64>(p[0]) << 16) | (static_cast<u64>(p[n >> 1]) << 8) | p[n - 1];
+        }
+        a ^= _SECRET[1];
+        b ^= seed;
+        _mum(a, b);
+        return _mix(a ^ _SECRET[0] ^ total, b ^ _SECRET[1]);
+    }
+
+    /// wyhash-style hash of a byte range
+    ORC_API inline auto hash_bytes(const std::span<const u8> bytes, const u64 seed = 0) noexcept -> u64 {
+        const u8* p = bytes.data();
+        usize n = bytes.size();
+        u64 s0 = _seed(seed), s1 = s0, s2 = s0;
+        for (; n > _BLOCK; p += _BLOCK, n -= _BLOCK)
+            _block(p, s0, s1, s2);
+        return _finish(p, n, bytes.size(), s0, s1, s2);
+    }
+    ORC_API inline auto hash_bytes(const std::string_view str, const u64 seed = 0) noexcept -> u64 {
+        return hash_bytes(std::span{reinterpret_cast<const u8*>(str.data()), str.size()}, seed);
+    }
+
+    /// single-multiply hash of an integer, much cheaper than hashing its bytes
+    ORC_API constexpr auto hash_int(const u64 value, const u64 seed = 0) noexcept -> u64 {
+        u64 a = value ^ _SECRET[0], b = seed ^ _SECRET[1];
+        _mum(a, b);
+        return _mix(a ^ _SECRET[0], b ^ _SECRET[1]);
+    }
+
+    /// order-dependent combination of two hashes
+    ORC_API constexpr auto combine(const u64 seed, const u64 hash) noexcept -> u64 {
+        return _mix(seed ^ _SECRET[2], hash ^ _SECRET[3]);
+    }
+
+    /// incremental hasher, feeding the same bytes in any number of pieces gives `hash_bytes` of their concatenation
+    class ORC_API hasher {
+    public:
+        explicit hasher(const u64 seed = 0) noexcept : s0(_seed(seed)), s1(s0), s2(s0) {}
+
+        auto write(const std::span<const u8> bytes) noexcept -> hasher& {
+            const u8* p = bytes.data();
+            usize n = bytes.size();
+            total += n;
+            if (buffered + n <= _BLOCK) {
+                if (n != 0) std::memcpy(buffer + buffered, p, n);
+                buffered += n;
+                return *this;
+            }
+            // a block is only consumed once more input follows it, the tail always stays buffered
+            if (buffered != 0) {
+                const usize fill = _BLOCK - buffered;
+                std::memcpy(buffer + buffered, p, fill);
+                p += fill;
+                n -= fill;
+                _block(buffer, s0, s1, s2);
+            }
+            for (; n > _BLOCK; p += _BLOCK, n -= _BLOCK)
+                _block(p, s0, s1, s2);
+            std::memcpy(buffer, p, n);
+            buffered = n;
+            return *this;
+        }
+        auto write(const std::string_view str) noexcept -> hasher& {
+            return write(std::span{reinterpret_cast<const u8*>(str.data()), str.size()});
+        }
+        template<core::concepts::integer T>
+        auto write(const T value) noexcept -> hasher& {
+            u8 bytes[sizeof(T)];
+            std::memcpy(bytes, &value, sizeof(T));
+            return write(std::span<const u8>{bytes, sizeof(T)});
+        }
+        template<hashable T>
+        auto write(const T& value) -> hasher& {
+            value.hash(*this);
+            return *this;
+        }
+
+        [[nodiscard]] auto finish() const noexcept -> u64 { return _finish(buffer, buffered, total, s0, s1, s2); }
+
+    private:
+        u64 s0, s1, s2;
+        u64 total = 0;
+        usize buffered = 0;
+        u8 buffer[_BLOCK]{};
+    };
+
+    /// hash functor used by orc containers: integers use `hash_int`, strings `hash_bytes`,
+    /// `hashable` types stream themselves and everything else falls back to `std::hash`
+    template<typename T>
+    struct ORC_API default_hash : std::hash<T> {};
+
+    template<core::concepts::integer T>
+    struct ORC_API default_hash<T> {
+        [[nodiscard]] constexpr auto operator()(const T value) const noexcept -> u64 { return hash_int(static_cast<u64>(value)); }
+    };
+
+    template<hashable T>
+    struct ORC_API default_hash<T> {
+        [[nodiscard]] auto operator()(const T& value) const -> u64 {
+            hasher state;
+            value.hash(state);
+            return state.finish();
+        }
+    };
+
+    /// transparent string hash: views, `std::string` and `hashable` orc strings with the same text hash equally
+    struct ORC_API string_hash {
+        using is_transparent = void;
+        [[nodiscard]] auto operator()(const std::string_view str) const noexcept -> u64 { return hash_bytes(str); }
+        template<hashable T>
+        [[nodiscard]] auto operator()(const T& str) const -> u64 { return default_hash<T>{}(str); }
+    };
+
+    template<>
+    struct ORC_API default_hash<std::string_view> : string_hash {};
+    template<>
+    struct ORC_API default_hash<std::string> : string_hash {};
+}
+
+/// `std::hash` bridge for every `hashable` orc type
+template<orc::hash::hashable T>
+struct std::hash<T> {
+    [[nodiscard]] auto operator()(const T& value) const -> std::size_t {
+        return static_cast<std::size_t>(orc::hash::default_hash<T>{}(value));
+    }
+};
@@ -4,9 +4,16 @@
 #include <ordefs.hpp>
 #include <functional>
 #include <container.hpp>
+#include <optional.hpp>
+#include <instrument.hpp>
 
+#include <cstddef>
+#include <iterator>
+#include <ranges>
+#include <span>
 #include <utility>
 #include <memory>
+#include <vector>
 
 using namespace orc::core::defines;
 using namespace orc::core::container;
@@ -15,12 +22,19 @@ namespace orc::iterators {
 
     struct iteration_end final : std::exception{};
 
-    #define foreach(varname, iterable, body)    \
-    while (true) {                              \
-        try {                                   \
-            auto varname = iterable.next();     \
-            body                                \
-        } catch(iteration_end&) {break;}        \
+    /// throws `iteration_end` on behalf of the iterator type `Self`
+    template<typename Self>
+    [[noreturn]] auto _end_iteration() -> void {
+        ORC_RECORD(Self, IterationEnd, 1);
+        throw iteration_end{};
+    }
+
+    #define foreach(varname, iterable, body)                \
+    while (true) {                                          \
+        auto varname##_next = iterable.try_next();          \
+        if (varname##_next.is_none()) break;                \
+        auto varname = varname##_next.unwrap_move();        \
+        body                                                \
     }
 
     template<typename Item, typename Out, typename Func>
@@ -29,6 +43,9 @@ namespace orc::iterators {
     template<typename T>
     class ORC_API iterator;
 
+    template<typename T>
+    class ORC_API iterator_view;
+
     template<typename T, typename Item>
     concept from_iterator = requires(std::unique_ptr<iterator<Item>> it)
     {
@@ -42,6 +59,11 @@ namespace orc::iterators {
         virtual ~iterator() = default;
         [[nodiscard]] virtual auto next() -> value_type = 0;
         [[nodiscard]] virtual auto has_next() const noexcept -> bool = 0;
+        /// non-throwing `next`, returns `none` once the iterator is exhausted
+        [[nodiscard]] virtual auto try_next() -> orc::optional::optional<value_type> {
+            if (!has_next()) return orc::optional::none;
+            return orc::optional::some(next());
+        }
         virtual auto clone() const -> std::unique_ptr<iterator> = 0;
         template<typename Out, typename Func>
         [[nodiscard]] auto map(Func func) -> std::unique_ptr<iterator> {
@@ -51,6 +73,72 @@ namespace orc::iterators {
         [[nodiscard]] auto collect() -> B {
             return B::from_iter(this->clone());
         }
+        /// `std::ranges::input_range` over a clone of this iterator
+        [[nodiscard]] auto as_view() const -> iterator_view<T> {
+            return iterator_view<T>(this->clone());
+        }
+    };
+
+    /// single-pass `std::ranges::view` pulling items from an orc iterator, for `std::ranges` algorithms
+    /// and range-for over adaptor chains. iterators into it are invalidated when the view is moved
+    template<typename T>
+    class ORC_API iterator_view : public std::ranges::view_interface<iterator_view<T>> {
+    public:
+        class cursor {
+        public:
+            using iterator_concept = std::input_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+
+            cursor() = default;
+            explicit cursor(iterator_view* view) : view(view) {}
+            [[nodiscard]] auto operator*() const -> const T& { return *view->current; }
+            auto operator++() -> cursor& {
+                view->advance();
+                return *this;
+            }
+            auto operator++(int) -> void { ++*this; }
+            [[nodiscard]] friend auto operator==(const cursor& it, std::default_sentinel_t) -> bool { return it.at_end(); }
+        private:
+            iterator_view* view = nullptr;
+
+            [[nodiscard]] auto at_end() const -> bool { return view->current.is_none(); }
+        };
+
+        iterator_view() = default;
+        explicit iterator_view(std::unique_ptr<iterator<T>> source) : source(std::move(source)) {}
+
+        /// pulls the first item, can be called once
+        [[nodiscard]] auto begin() -> cursor {
+            advance();
+            return cursor(this);
+        }
+        [[nodiscard]] auto end() const noexcept -> std::default_sentinel_t { return std::default_sentinel; }
+    private:
+        std::unique_ptr<iterator<T>> source;
+        orc::optional::optional<T> current = orc::optional::none;
+
+        auto advance() -> void {
+            if (source == nullptr) return;
+            current = source->try_next();
+        }
+    };
+
+    /// iterator whose items can be computed from their index, so positioning costs O(1)
+    template<typename T>
+    class ORC_API random_access_iterator : public iterator<T> {
+    public:
+        /// remaining items, `none` when the source is unbounded
+        [[nodiscard]] virtual auto len() const noexcept -> orc::optional::optional<usize> = 0;
+        /// remaining item `idx` without consuming anything
+        [[nodiscard]] virtual auto peek_nth(usize idx) const -> orc::optional::optional<T> = 0;
+        /// drops the next `n` items, stops at the end of a bounded source
+        virtual auto advance_by(usize n) noexcept -> void = 0;
+        /// consumes the next `n + 1` items and returns the last of them
+        [[nodiscard]] auto nth(const usize n) -> orc::optional::optional<T> {
+            advance_by(n);
+            return this->try_next();
+        }
     };
 
 
@@ -61,12 +149,18 @@ namespace orc::iterators {
     public:
         map_iter(Func func, std::unique_ptr<iterator<Item>> iter) : action(std::move(func)), obj(std::move(iter)) {}
         auto clone() const -> std::unique_ptr<iterator<Out>> override {
+            ORC_RECORD(map_iter, IteratorClone, 1);
             return std::make_unique<map_iter>(action, obj->clone());
         }
         [[nodiscard]] auto next() -> Out override {
             try { return action(obj->next()); }
             catch (iteration_end&) { throw; }
         }
+        [[nodiscard]] auto try_next() -> orc::optional::optional<Out> override {
+            auto item = obj->try_next();
+            if (item.is_none()) return orc::optional::none;
+            return orc::optional::some(action(item.unwrap_move()));
+        }
         [[nodiscard]] auto has_next() const noexcept -> bool override { return obj->has_next(); }
     private:
         Func action;
@@ -77,19 +171,26 @@ namespace orc::iterators {
     class ORC_API std_vector_iterator final : public iterator<T> {
     public:
         explicit std_vector_iterator(std::vector<T>& vec) {
-            begin = vec.begin()._Unwrapped();
-            end = vec.end()._Unwrapped();
+            begin = vec.data();
+            end = vec.data() + vec.size();
         }
         auto clone() const -> std::unique_ptr<iterator<T>> override {
+            ORC_RECORD(std_vector_iterator, IteratorClone, 1);
             return std::make_unique<std_vector_iterator>(*this);
         }
         [[nodiscard]] constexpr auto has_next() const noexcept -> bool override { return begin+pos != end; }
         [[nodiscard]] constexpr auto next() -> typename iterator<T>::value_type override {
-            if (!has_next()) throw iteration_end{};
+            if (!has_next()) _end_iteration<std_vector_iterator>();
             auto tmp = *(begin + pos);
             pos++;
             return tmp;
         }
+        [[nodiscard]] constexpr auto try_next() -> orc::optional::optional<T> override {
+            if (!has_next()) return orc::optional::none;
+            return orc::optional::some(*(begin + pos++));
+        }
+        /// elements not consumed yet
+        [[nodiscard]] constexpr auto as_span() const noexcept -> std::span<T> { return {begin + pos, end}; }
     private:
         T* begin = nullptr;
         T* end = nullptr;
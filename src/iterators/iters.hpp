@@ -1,6 +1,9 @@
 #pragma once
 #include <orc_export.hpp>
 #include <ordefs.hpp>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
 #include <iterator.hpp>
 #include <vector.hpp>
 
@@ -8,31 +11,140 @@ using namespace orc::core::defines;
 using namespace orc::containers;
 
 namespace orc::iterators {
+
+    /// `start + step * i` with `i` counted in `usize`. integers are computed modulo 2^64 and truncated,
+    /// which gives the same wrapped value as stepping `i` times
     template<typename T>
     requires (std::is_arithmetic_v<T>)
-    class ORC_API infinity_range_iterator final : public iterator<T> {
+    [[nodiscard]] constexpr auto _range_at(const T start, const T step, const usize i) noexcept -> T {
+        if constexpr (std::is_integral_v<T>)
+            return static_cast<T>(static_cast<u64>(start) + static_cast<u64>(step) * static_cast<u64>(i));
+        else
+            return start + step * static_cast<T>(i);
+    }
+
+    /// `n` items of `start + step * i`. every operation except iteration itself is O(1),
+    /// and `skip`, `step_by` and `take` return new ranges instead of copying
+    template<typename T>
+    requires (std::is_arithmetic_v<T>)
+    class ORC_API range_iterator final : public random_access_iterator<T> {
+    public:
+        constexpr range_iterator(T from, T stp, usize n) : start(from), step(stp), end(n) {}
+        /// `from, from + stp, ...` while below `to` (above it for a negative step)
+        [[nodiscard]] static constexpr auto between(const T from, const T to, const T stp = 1) -> range_iterator {
+            if (stp == 0) throw std::invalid_argument("range step must not be zero");
+            if (stp > 0 ? to <= from : to >= from) return range_iterator(from, stp, 0);
+            if constexpr (std::is_integral_v<T>) {
+                using U = std::make_unsigned_t<T>;
+                const U distance = stp > 0 ? static_cast<U>(to) - static_cast<U>(from) : static_cast<U>(from) - static_cast<U>(to);
+                const U stride = stp > 0 ? static_cast<U>(stp) : static_cast<U>(U{0} - static_cast<U>(stp));
+                return range_iterator(from, stp, static_cast<usize>((distance - 1) / stride + 1));
+            } else {
+                return range_iterator(from, stp, static_cast<usize>(std::ceil((to - from) / stp)));
+            }
+        }
+
+        [[nodiscard]] constexpr auto has_next() const noexcept -> bool override { return pos < end; }
+        [[nodiscard]] constexpr auto next() -> typename iterator<T>::value_type override {
+            if (!has_next()) _end_iteration<range_iterator>();
+            return _range_at(start, step, pos++);
+        }
+        [[nodiscard]] constexpr auto try_next() -> orc::optional::optional<T> override {
+            if (!has_next()) return orc::optional::none;
+            return orc::optional::some(_range_at(start, step, pos++));
+        }
+        auto clone() const -> std::unique_ptr<iterator<T>> override {
+            ORC_RECORD(range_iterator, IteratorClone, 1);
+            return std::make_unique<range_iterator>(*this);
+        }
+
+        [[nodiscard]] constexpr auto len() const noexcept -> orc::optional::optional<usize> override { return orc::optional::some(size()); }
+        [[nodiscard]] constexpr auto peek_nth(const usize idx) const -> orc::optional::optional<T> override {
+            if (idx >= size()) return orc::optional::none;
+            return orc::optional::some(_range_at(start, step, pos + idx));
+        }
+        constexpr auto advance_by(const usize n) noexcept -> void override { pos += std::min<usize>(n, size()); }
+
+        /// remaining items
+        [[nodiscard]] constexpr auto size() const noexcept -> usize { return end - pos; }
+        [[nodiscard]] constexpr auto count() const noexcept -> usize { return size(); }
+        /// remaining items without the first `n`
+        [[nodiscard]] constexpr auto skip(const usize n) const noexcept -> range_iterator {
+            range_iterator out = *this;
+            out.advance_by(n);
+            return out;
+        }
+        /// at most the next `n` items
+        [[nodiscard]] constexpr auto take(const usize n) const noexcept -> range_iterator {
+            return range_iterator(_range_at(start, step, pos), step, std::min<usize>(n, size()));
+        }
+        /// every `k`-th remaining item, starting with the next one
+        [[nodiscard]] constexpr auto step_by(const usize k) const -> range_iterator {
+            if (k == 0) throw std::invalid_argument("step_by needs a positive step");
+            return range_iterator(_range_at(start, step, pos), _range_at(T{0}, step, k), (size() + k - 1) / k);
+        }
+        [[nodiscard]] constexpr auto last() const noexcept -> orc::optional::optional<T> {
+            if (size() == 0) return orc::optional::none;
+            return orc::optional::some(_range_at(start, step, end - 1));
+        }
+        /// sum of the remaining items as `n * first + step * n * (n - 1) / 2`. integers wrap like repeated addition would
+        [[nodiscard]] constexpr auto sum() const noexcept -> T {
+            const usize n = size();
+            const T first = _range_at(start, step, pos);
+            if constexpr (std::is_integral_v<T>) {
+                const usize pairs = n % 2 == 0 ? (n / 2) * (n - 1) : n * ((n - 1) / 2);
+                return static_cast<T>(static_cast<u64>(_range_at(T{0}, first, n)) + static_cast<u64>(_range_at(T{0}, step, pairs)));
+            } else {
+                const T items = static_cast<T>(n);
+                return items * first + step * (items * (items - 1) / 2);
+            }
+        }
+    private:
+        T start;
+        T step;
+        usize end;
+        usize pos = 0;
+    };
+
+    template<typename T>
+    requires (std::is_arithmetic_v<T>)
+    class ORC_API infinity_range_iterator final : public random_access_iterator<T> {
     public:
         constexpr infinity_range_iterator(T from, T stp) : start(from), step(stp) {}
         constexpr infinity_range_iterator() : start(0), step(1) {}
         explicit constexpr infinity_range_iterator(T from) : start(from), step(1) {}
         [[nodiscard]] constexpr auto has_next() const noexcept -> bool override { return true; }
         [[nodiscard]] constexpr auto next() -> typename iterator<T>::value_type override {
-            T tmp = start + step * i;
-            i += 1;
-            return tmp;
+            return _range_at(start, step, i++);
+        }
+        [[nodiscard]] constexpr auto try_next() -> orc::optional::optional<T> override {
+            return orc::optional::some(next());
         }
         auto clone() const -> std::unique_ptr<iterator<T>> override {
-            return std::make_unique<infinity_range_iterator>(start, step);
+            ORC_RECORD(infinity_range_iterator, IteratorClone, 1);
+            return std::make_unique<infinity_range_iterator>(*this);
+        }
+
+        [[nodiscard]] constexpr auto len() const noexcept -> orc::optional::optional<usize> override { return orc::optional::none; }
+        [[nodiscard]] constexpr auto peek_nth(const usize idx) const -> orc::optional::optional<T> override {
+            return orc::optional::some(_range_at(start, step, i + idx));
+        }
+        constexpr auto advance_by(const usize n) noexcept -> void override { i += n; }
+
+        [[nodiscard]] constexpr auto skip(const usize n) const noexcept -> infinity_range_iterator {
+            return infinity_range_iterator(_range_at(start, step, i + n), step);
+        }
+        [[nodiscard]] constexpr auto step_by(const usize k) const -> infinity_range_iterator {
+            if (k == 0) throw std::invalid_argument("step_by needs a positive step");
+            return infinity_range_iterator(_range_at(start, step, i), _range_at(T{0}, step, k));
         }
-        [[nodiscard]] constexpr auto take(const usize n) -> std::shared_ptr<container<T>> {
-            vector<T> vec;
-            for (usize i = 0; i < n; i++)
-                vec.push(start + step * i);
-            return std::static_pointer_cast<container<T>, vector<T>>(std::make_shared<vector<T>>(vec));
+        /// the next `n` items as a bounded range, nothing is materialized
+        [[nodiscard]] constexpr auto take(const usize n) const noexcept -> range_iterator<T> {
+            return range_iterator<T>(_range_at(start, step, i), step, n);
         }
     private:
         T start;
         T step;
-        T i = 0;
+        usize i = 0;
     };
-}
\ No newline at end of file
+}
@@ -2,7 +2,12 @@
 #include <orc_export.hpp>
 #include <ordefs.hpp>
 #include <type_traits>
+#include <functional>
 #include <stdexcept>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <instrument.hpp>
 
 using namespace orc::core::defines;
 
@@ -21,7 +26,7 @@ namespace orc::optional {
     struct _some_t_wrapper {
         template<typename T>
         [[nodiscard]] constexpr auto operator()(T&& value) const -> _some_t<T> {
-            return _some_t{std::forward<T>(value)};
+            return _some_t<T>{std::forward<T>(value)};
         }
         template<typename... Args>
         [[nodiscard]] constexpr auto operator()(Args&&... args) const -> _some_t_args<Args...> {
@@ -33,99 +38,207 @@ namespace orc::optional {
     static constexpr auto some = _some_t_wrapper{};
     static constexpr auto none = _none_t{};
 
+    /// types with a spare value that can encode `none` without an extra flag. opt-in only: specialize it
+    /// just for types whose sentinel can never be a valid value, pointers don't qualify as `some(nullptr)` is legal
+    template<typename T>
+    struct ORC_API niche {
+        static constexpr bool enabled = false;
+    };
+    /// helper for `niche` specializations which reserve a single sentinel value
+    template<typename T, T Sentinel>
+    struct ORC_API sentinel_niche {
+        static constexpr bool enabled = true;
+        [[nodiscard]] static constexpr auto sentinel() noexcept -> T { return Sentinel; }
+        [[nodiscard]] static constexpr auto is_sentinel(const T& value) noexcept -> bool { return value == Sentinel; }
+    };
+    template<typename T>
+    class ORC_API optional;
+
+    template<typename T, bool = niche<T>::enabled>
+    struct _optional_storage {
+        union {
+            _none_t empty;
+            T value;
+        };
+        bool engaged = false;
+
+        constexpr _optional_storage() noexcept : empty{} {}
+
+        constexpr _optional_storage(const _optional_storage&)
+            requires std::is_trivially_copy_constructible_v<T> = default;
+        constexpr _optional_storage(const _optional_storage& other)
+            requires (std::is_copy_constructible_v<T> && !std::is_trivially_copy_constructible_v<T>) : empty{} {
+            if (other.engaged) copy_from(other.value);
+        }
+        constexpr _optional_storage(_optional_storage&&)
+            requires std::is_trivially_move_constructible_v<T> = default;
+        constexpr _optional_storage(_optional_storage&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+            requires (std::is_move_constructible_v<T> && !std::is_trivially_move_constructible_v<T>) : empty{} {
+            if (other.engaged) move_from(std::move(other.value));
+        }
 
-    template<typename T, class Alloc = std::allocator<T>>
-    [[deprecated("unstable and unfinished class, do not use")]]
-    class ORC_API optional {
-    public:
-        optional() = default;
-
-        optional(_some_t<T>&& some) {
-            storage = alloc_traits::allocate(allocator, 1);
-            alloc_traits::construct(allocator, storage, std::move(some.value));
+        constexpr auto operator=(const _optional_storage&) -> _optional_storage&
+            requires std::is_trivially_copyable_v<T> = default;
+        constexpr auto operator=(const _optional_storage& other) -> _optional_storage&
+            requires (std::is_copy_constructible_v<T> && !std::is_trivially_copyable_v<T>) {
+            if (this == &other) return *this;
+            reset();
+            if (other.engaged) copy_from(other.value);
+            return *this;
         }
-        optional(_none_t&&) noexcept { storage = nullptr; }
-        optional(_none_t) noexcept { storage = nullptr; }
-        template<typename... Args>
-        optional(_some_t_args<Args...>&& arg) {
-            storage = alloc_traits::allocate(allocator, 1);
-            std::apply([this](auto&&... elems) {
-                alloc_traits::construct(allocator, storage, std::forward<decltype(elems)>(elems)...);
-            }, std::move(arg.args));
+        constexpr auto operator=(_optional_storage&&) -> _optional_storage&
+            requires std::is_trivially_copyable_v<T> = default;
+        constexpr auto operator=(_optional_storage&& other) noexcept(std::is_nothrow_move_constructible_v<T>) -> _optional_storage&
+            requires (std::is_move_constructible_v<T> && !std::is_trivially_copyable_v<T>) {
+            if (this == &other) return *this;
+            reset();
+            if (other.engaged) move_from(std::move(other.value));
+            return *this;
         }
 
-        optional(const optional& other) {
-            if (other.storage != nullptr) {
-                storage = alloc_traits::allocate(allocator, 1);
-                alloc_traits::construct(allocator, storage, *other.storage);
-                allocator = other.allocator;
-            } else storage = nullptr;
+        constexpr ~_optional_storage() requires std::is_trivially_destructible_v<T> = default;
+        constexpr ~_optional_storage() { reset(); }
+
+        template<typename... Args>
+        constexpr auto construct(Args&&... args) -> void {
+            std::construct_at(std::addressof(value), std::forward<Args>(args)...);
+            engaged = true;
+            ORC_RECORD(optional<T>, Construction, 1);
+        }
+        constexpr auto copy_from(const T& other) -> void {
+            construct(other);
+            ORC_RECORD(optional<T>, BytesCopied, sizeof(T));
         }
-        optional(optional&& other) noexcept {
-            storage = other.storage;
-            allocator = std::move(other.allocator);
-            other.storage = nullptr;
+        constexpr auto move_from(T&& other) -> void {
+            construct(std::move(other));
+            ORC_RECORD(optional<T>, BytesMoved, sizeof(T));
         }
+        constexpr auto reset() noexcept -> void {
+            if (engaged) {
+                std::destroy_at(std::addressof(value));
+                engaged = false;
+            }
+        }
+        [[nodiscard]] constexpr auto has_value() const noexcept -> bool { return engaged; }
+    };
 
-        auto operator=(optional other) noexcept -> optional& {
-            swap(*this, other);
-            return *this;
+    template<typename T>
+    struct _optional_storage<T, true> {
+        static_assert(std::is_trivially_copyable_v<T>, "niche-optimized types must be trivially copyable");
+        T value = niche<T>::sentinel();
+
+        template<typename... Args>
+        constexpr auto construct(Args&&... args) -> void {
+            value = T(std::forward<Args>(args)...);
+            ORC_RECORD(optional<T>, Construction, 1);
         }
+        constexpr auto reset() noexcept -> void { value = niche<T>::sentinel(); }
+        [[nodiscard]] constexpr auto has_value() const noexcept -> bool { return !niche<T>::is_sentinel(value); }
+    };
 
-        friend auto swap(optional& lhs, optional& rhs) noexcept -> void {
-            std::swap(lhs.storage, rhs.storage);
-            std::swap(lhs.allocator, rhs.allocator);
+    template<typename T>
+    class ORC_API optional : private _optional_storage<T> {
+    public:
+        using value_type = T;
+
+        constexpr optional() noexcept = default;
+        constexpr optional(_none_t) noexcept {} // NOLINT
+        template<typename U>
+        requires std::is_constructible_v<T, U&&>
+        constexpr optional(_some_t<U>&& some) { this->construct(std::forward<U>(some.value)); } // NOLINT
+        template<typename... Args>
+        constexpr optional(_some_t_args<Args...>&& arg) { // NOLINT
+            std::apply([this](auto&&... elems) {
+                this->construct(std::forward<decltype(elems)>(elems)...);
+            }, std::move(arg.args));
         }
 
-        ~optional() {
-            if (storage != nullptr) {
-                if constexpr (std::is_destructible_v<T>) alloc_traits::destroy(allocator, storage);
-                alloc_traits::deallocate(allocator, storage, 1);
-            }
+        constexpr auto operator=(_none_t) noexcept -> optional& {
+            this->reset();
+            return *this;
         }
 
-        [[nodiscard]] constexpr auto is_some() const noexcept -> bool { return storage != nullptr; }
-        [[nodiscard]] constexpr auto is_none() const noexcept -> bool { return storage == nullptr; }
-        [[nodiscard]] constexpr auto unwrap_move() -> T {
-            if (storage == nullptr) throw std::runtime_error("cannot unwrap `none` value");
-            T tmp = std::move(*storage);
-            alloc_traits::destroy(allocator, storage);
-            alloc_traits::deallocate(allocator, storage, 1);
-            storage = nullptr;
-            return tmp;
+        [[nodiscard]] constexpr auto is_some() const noexcept -> bool { return this->has_value(); }
+        [[nodiscard]] constexpr auto is_none() const noexcept -> bool { return !this->has_value(); }
+        [[nodiscard]] constexpr explicit operator bool() const noexcept { return this->has_value(); }
+
+        [[nodiscard]] constexpr auto unwrap() const& -> const T& {
+            if (is_none()) [[unlikely]] throw std::runtime_error("cannot unwrap `none` value");
+            return this->value;
         }
-        [[nodiscard]] constexpr auto unwrap() const -> const T& {
-            if (storage == nullptr) throw std::runtime_error("cannot unwrap `none` value");
-            return *storage;
+        [[nodiscard]] constexpr auto unwrap() & -> T& {
+            if (is_none()) [[unlikely]] throw std::runtime_error("cannot unwrap `none` value");
+            return this->value;
         }
-        [[nodiscard]] constexpr auto unwrap() -> T& {
-            if (storage == nullptr) throw std::runtime_error("cannot unwrap `none` value");
-            return *storage;
+        [[nodiscard]] constexpr auto unwrap_move() -> T {
+            if (is_none()) [[unlikely]] throw std::runtime_error("cannot unwrap `none` value");
+            T tmp = std::move(this->value);
+            this->reset();
+            return tmp;
         }
         [[nodiscard]] constexpr auto expect(const std::string& msg) -> T {
-            if (storage == nullptr) throw std::runtime_error(msg);
-            T tmp = std::move(*storage);
-            alloc_traits::destroy(allocator, storage);
-            alloc_traits::deallocate(allocator, storage, 1);
-            storage = nullptr;
+            if (is_none()) [[unlikely]] throw std::runtime_error(msg);
+            T tmp = std::move(this->value);
+            this->reset();
             return tmp;
         }
-        using alloc_traits = std::allocator_traits<Alloc>;
+        /// unchecked access, `is_some()` must hold
+        [[nodiscard]] constexpr auto operator*() const& noexcept -> const T& { return this->value; }
+        [[nodiscard]] constexpr auto operator*() & noexcept -> T& { return this->value; }
+        [[nodiscard]] constexpr auto operator*() && noexcept -> T&& { return std::move(this->value); }
+        [[nodiscard]] constexpr auto operator->() const noexcept -> const T* { return std::addressof(this->value); }
+        [[nodiscard]] constexpr auto operator->() noexcept -> T* { return std::addressof(this->value); }
+
+        [[nodiscard]] constexpr auto unwrap_or(T def) const& -> T {
+            if (is_some()) return this->value;
+            return def;
+        }
+        [[nodiscard]] constexpr auto unwrap_or(T def) && -> T {
+            if (is_some()) return std::move(this->value);
+            return def;
+        }
+        template<typename Func>
+        [[nodiscard]] constexpr auto unwrap_or_else(Func func) const& -> T {
+            if (is_some()) return this->value;
+            return std::invoke(func);
+        }
 
-    private:
-        explicit optional(T&& value) {
-            storage = alloc_traits::allocate(allocator, 1);
-            alloc_traits::construct(allocator, storage, std::move(value));
+        template<typename Func>
+        [[nodiscard]] constexpr auto map(Func func) const& -> optional<std::remove_cvref_t<std::invoke_result_t<Func, const T&>>> {
+            if (is_some()) return some(std::invoke(func, this->value));
+            return none;
         }
-        template<typename... Args>
-        explicit optional(Args&&... args) {
-            storage = alloc_traits::allocate(allocator, 1);
-            alloc_traits::construct(allocator, storage, std::forward<Args>(args)...);
+        template<typename Func>
+        [[nodiscard]] constexpr auto map(Func func) && -> optional<std::remove_cvref_t<std::invoke_result_t<Func, T&&>>> {
+            if (is_some()) return some(std::invoke(func, std::move(this->value)));
+            return none;
+        }
+        template<typename Func>
+        [[nodiscard]] constexpr auto and_then(Func func) const& -> std::invoke_result_t<Func, const T&> {
+            if (is_some()) return std::invoke(func, this->value);
+            return none;
+        }
+        template<typename Func>
+        [[nodiscard]] constexpr auto and_then(Func func) && -> std::invoke_result_t<Func, T&&> {
+            if (is_some()) return std::invoke(func, std::move(this->value));
+            return none;
         }
-        T* storage = nullptr;
-        Alloc allocator;
-    };
 
+        /// moves the value out and leaves `none` behind
+        [[nodiscard]] constexpr auto take() -> optional {
+            optional tmp = std::move(*this);
+            this->reset();
+            return tmp;
+        }
+        constexpr auto reset() noexcept -> void { _optional_storage<T>::reset(); }
 
+        [[nodiscard]] friend constexpr auto operator==(const optional& left, const optional& right) -> bool {
+            if (left.is_some() != right.is_some()) return false;
+            return left.is_none() || left.value == right.value;
+        }
+        [[nodiscard]] friend constexpr auto operator==(const optional& left, _none_t) noexcept -> bool {
+            return left.is_none();
+        }
+    };
 
 }
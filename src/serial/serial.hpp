@@ -0,0 +1,366 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include <orc_export.hpp>
+#include <ordefs.hpp>
+
+#include "expected.hpp"
+#include "optional.hpp"
+#include "redtime.hpp"
+#include "rfloat.hpp"
+#include "rstring.hpp"
+#include "vector.hpp"
+
+using namespace orc::core::defines;
+
+/// compact binary format: fixed-width little-endian scalars, u64 length prefixes and u8 tags.
+/// arrays of `bulk` types are padded to their alignment and copied as one block, so they can be read in place
+namespace orc::serial {
+
+    enum class ORC_API serial_error {
+        UnexpectedEnd,
+        InvalidTag,
+        InvalidValue,
+        Misaligned,
+        TrailingData,
+    };
+
+    class writer;
+    class reader;
+
+    /// `static auto write(writer&, const T&) -> void` and `static auto read(reader&) -> expected<T, serial_error>`,
+    /// plus `static constexpr bool BULK` when the encoding equals the in-memory representation
+    template<typename T>
+    struct serializer;
+
+    template<typename T>
+    concept writable = requires(writer& w, const T& value) { serializer<T>::write(w, value); };
+    template<typename T>
+    concept serializable = writable<T> && requires(reader& r) { serializer<T>::read(r); };
+    /// types decoded in place by `static auto read_into(reader&, T&) -> expected<bool, serial_error>`
+    template<typename T>
+    concept readable_into = writable<T> && requires(reader& r, T& out) { serializer<T>::read_into(r, out); };
+
+    template<typename T>
+    concept bulk = serializable<T> && std::is_trivially_copyable_v<T> && requires { requires serializer<T>::BULK; };
+
+    template<typename T>
+    [[nodiscard]] constexpr auto _to_little(const T value) noexcept -> T {
+        if constexpr (std::endian::native == std::endian::little || sizeof(T) == 1) {
+            return value;
+        } else {
+            auto bytes = std::bit_cast<std::array<u8, sizeof(T)>>(value);
+            std::reverse(bytes.begin(), bytes.end());
+            return std::bit_cast<T>(bytes);
+        }
+    }
+
+    class ORC_API writer {
+    public:
+        writer() = default;
+        explicit writer(const usize initial_cap) { buffer.reserve(initial_cap); }
+
+        auto write_bytes(const std::span<const u8> bytes) -> void { buffer.insert(buffer.end(), bytes.begin(), bytes.end()); }
+        template<typename T>
+        requires std::is_arithmetic_v<T>
+        auto write_raw(const T value) -> void {
+            const T little = _to_little(value);
+            u8 bytes[sizeof(T)];
+            std::memcpy(bytes, &little, sizeof(T));
+            write_bytes(bytes);
+        }
+        auto write_len(const usize len) -> void { write_raw<u64>(len); }
+        auto write_tag(const u8 tag) -> void { buffer.push_back(tag); }
+        auto write_str(const std::string_view str) -> void {
+            write_len(str.size());
+            write_bytes({reinterpret_cast<const u8*>(str.data()), str.size()});
+        }
+        /// zero padding up to a multiple of `alignment` from the start of the buffer
+        auto pad(const usize alignment) -> void { buffer.resize((buffer.size() + alignment - 1) / alignment * alignment, 0); }
+
+        template<writable T>
+        auto write(const T& value) -> writer& {
+            serializer<T>::write(*this, value);
+            return *this;
+        }
+        /// length-prefixed array, `bulk` elements are aligned and copied as one block
+        template<serializable T>
+        auto write_array(const std::span<const T> values) -> void {
+            write_len(values.size());
+            if constexpr (bulk<T>) {
+                pad(alignof(T));
+                write_bytes({reinterpret_cast<const u8*>(values.data()), values.size_bytes()});
+            } else {
+                for (const auto& value : values) serializer<T>::write(*this, value);
+            }
+        }
+
+        [[nodiscard]] auto size() const noexcept -> usize { return buffer.size(); }
+        [[nodiscard]] auto bytes() const noexcept -> std::span<const u8> { return buffer; }
+        [[nodiscard]] auto take() noexcept -> std::vector<u8> { return std::move(buffer); }
+
+    private:
+        std::vector<u8> buffer;
+    };
+
+    /// cursor over serialized bytes, never copies more than the values it returns
+    class ORC_API reader {
+    public:
+        explicit reader(const std::span<const u8> bytes) noexcept : bytes(bytes) {}
+
+        [[nodiscard]] auto position() const noexcept -> usize { return pos; }
+        [[nodiscard]] auto remaining() const noexcept -> usize { return bytes.size() - pos; }
+        [[nodiscard]] auto is_done() const noexcept -> bool { return pos == bytes.size(); }
+
+        [[nodiscard]] auto read_bytes(const usize n) -> expected::expected<std::span<const u8>, serial_error> {
+            if (n > remaining()) [[unlikely]] return expected::cold_err(serial_error::UnexpectedEnd);
+            const auto out = bytes.subspan(pos, n);
+            pos += n;
+            return expected::ok(std::span<const u8>(out));
+        }
+        template<typename T>
+        requires std::is_arithmetic_v<T>
+        [[nodiscard]] auto read_raw() -> expected::expected<T, serial_error> {
+            if (sizeof(T) > remaining()) [[unlikely]] return expected::cold_err(serial_error::UnexpectedEnd);
+            T value;
+            std::memcpy(&value, bytes.data() + pos, sizeof(T));
+            pos += sizeof(T);
+            return expected::ok(_to_little(value));
+        }
+        [[nodiscard]] auto read_len() -> expected::expected<usize, serial_error> {
+            ORC_TRY(len, read_raw<u64>())
+            return expected::ok(static_cast<usize>(len));
+        }
+        [[nodiscard]] auto read_tag() -> expected::expected<u8, serial_error> { return read_raw<u8>(); }
+        /// view into the underlying bytes
+        [[nodiscard]] auto read_str() -> expected::expected<std::string_view, serial_error> {
+            ORC_TRY(len, read_len())
+            ORC_TRY(raw, read_bytes(len))
+            return expected::ok(std::string_view(reinterpret_cast<const char*>(raw.data()), raw.size()));
+        }
+        /// skips the padding written by `writer::pad`
+        [[nodiscard]] auto skip_pad(const usize alignment) -> expected::expected<usize, serial_error> {
+            const usize target = (pos + alignment - 1) / alignment * alignment;
+            if (target > bytes.size()) [[unlikely]] return expected::cold_err(serial_error::UnexpectedEnd);
+            pos = target;
+            return expected::ok(usize{target});
+        }
+
+        template<serializable T>
+        [[nodiscard]] auto read() -> expected::expected<T, serial_error> { return serializer<T>::read(*this); }
+        template<readable_into T>
+        [[nodiscard]] auto read_into(T& out) -> expected::expected<bool, serial_error> { return serializer<T>::read_into(*this, out); }
+
+        /// zero-copy view of an array written by `writer::write_array`, the input must outlive the span.
+        /// fails with `Misaligned` when the input buffer itself is not aligned for `T`
+        template<bulk T>
+        [[nodiscard]] auto read_span() -> expected::expected<std::span<const T>, serial_error> {
+            ORC_TRY(len, read_len())
+            ORC_TRY(start, skip_pad(alignof(T)))
+            if (len > remaining() / sizeof(T)) [[unlikely]] return expected::cold_err(serial_error::UnexpectedEnd);
+            const u8* p = bytes.data() + start;
+            if (reinterpret_cast<std::uintptr_t>(p) % alignof(T) != 0) [[unlikely]] return expected::cold_err(serial_error::Misaligned);
+            pos += len * sizeof(T);
+            return expected::ok(std::span<const T>(reinterpret_cast<const T*>(p), len));
+        }
+        /// array written by `writer::write_array`, passed element by element to `sink`
+        template<serializable T, typename Sink>
+        [[nodiscard]] auto read_array(Sink&& sink) -> expected::expected<usize, serial_error> {
+            ORC_TRY(len, read_len())
+            if constexpr (bulk<T>) {
+                ORC_TRY(start, skip_pad(alignof(T)))
+                if (len > remaining() / sizeof(T)) [[unlikely]] return expected::cold_err(serial_error::UnexpectedEnd);
+                (void)start;
+                for (usize i = 0; i < len; ++i) {
+                    T value;
+                    std::memcpy(&value, bytes.data() + pos + i * sizeof(T), sizeof(T));
+                    sink(std::move(value));
+                }
+                pos += len * sizeof(T);
+            } else {
+                for (usize i = 0; i < len; ++i) {
+                    ORC_TRY(value, serializer<T>::read(*this))
+                    sink(std::move(value));
+                }
+            }
+            return expected::ok(usize{len});
+        }
+
+    private:
+        std::span<const u8> bytes;
+        usize pos = 0;
+    };
+
+    template<writable T>
+    ORC_API auto to_bytes(const T& value) -> std::vector<u8> {
+        writer w;
+        w.write(value);
+        return w.take();
+    }
+    /// reads exactly one `T`, leftover bytes are an error
+    template<serializable T>
+    ORC_API auto from_bytes(const std::span<const u8> bytes) -> expected::expected<T, serial_error> {
+        reader r(bytes);
+        ORC_TRY(value, r.read<T>())
+        if (!r.is_done()) [[unlikely]] return expected::cold_err(serial_error::TrailingData);
+        return expected::ok(std::move(value));
+    }
+
+    template<typename T>
+    requires (std::is_arithmetic_v<T> && !std::is_same_v<T, bool>) || std::is_enum_v<T>
+    struct ORC_API serializer<T> {
+        static constexpr bool BULK = std::endian::native == std::endian::little;
+        static auto write(writer& w, const T value) -> void {
+            if constexpr (std::is_enum_v<T>) w.write_raw(static_cast<std::underlying_type_t<T>>(value));
+            else w.write_raw(value);
+        }
+        static auto read(reader& r) -> expected::expected<T, serial_error> {
+            if constexpr (std::is_enum_v<T>) {
+                ORC_TRY(raw, r.read_raw<std::underlying_type_t<T>>())
+                return expected::ok(static_cast<T>(raw));
+            } else {
+                return r.read_raw<T>();
+            }
+        }
+    };
+
+    template<>
+    struct ORC_API serializer<bool> {
+        static auto write(writer& w, const bool value) -> void { w.write_tag(value ? 1 : 0); }
+        static auto read(reader& r) -> expected::expected<bool, serial_error> {
+            ORC_TRY(tag, r.read_tag())
+            if (tag > 1) [[unlikely]] return expected::cold_err(serial_error::InvalidValue);
+            return expected::ok(tag == 1);
+        }
+    };
+
+    template<>
+    struct ORC_API serializer<std::string> {
+        static auto write(writer& w, const std::string& value) -> void { w.write_str(value); }
+        static auto read(reader& r) -> expected::expected<std::string, serial_error> {
+            ORC_TRY(view, r.read_str())
+            return expected::ok(std::string(view));
+        }
+    };
+
+    template<serializable T, class Alloc>
+    struct ORC_API serializer<containers::vector<T, Alloc>> {
+        static auto write(writer& w, const containers::vector<T, Alloc>& value) -> void {
+            w.write_array(std::span<const T>(value.start(), value.size()));
+        }
+        static auto read(reader& r) -> expected::expected<containers::vector<T, Alloc>, serial_error> {
+            containers::vector<T, Alloc> out;
+            if constexpr (bulk<T>) {
+                // one copy straight from the input when it is aligned for `T`, the result must not depend on that
+                const reader start = r;
+                auto view = r.read_span<T>();
+                if (view.is_ok()) {
+                    out.push(view.unwrap());
+                    return expected::ok(std::move(out));
+                }
+                if (view.get_err() != serial_error::Misaligned) return expected::cold_err(view.get_err());
+                r = start;
+            }
+            ORC_TRY(count, r.read_array<T>([&out](T&& value) { out.push(value); }))
+            (void)count;
+            return expected::ok(std::move(out));
+        }
+    };
+
+    template<class Alloc>
+    struct ORC_API serializer<strings::mutable_u8string<Alloc>> {
+        /// utf-8 bytes with a byte-length prefix
+        static auto write(writer& w, const strings::mutable_u8string<Alloc>& value) -> void {
+            usize total = 0;
+            for (usize i = 0; i < value.size(); ++i) total += value[i].bytes().size();
+            w.write_len(total);
+            for (usize i = 0; i < value.size(); ++i) w.write_bytes(value[i].bytes());
+        }
+        static auto read(reader& r) -> expected::expected<strings::mutable_u8string<Alloc>, serial_error> {
+            ORC_TRY(text, r.read_str())
+            strings::mutable_u8string<Alloc> out;
+            const auto* p = reinterpret_cast<const u8*>(text.data());
+            for (usize i = 0; i < text.size();) {
+                const u8 lead = p[i];
+                const usize n = lead < 0x80 ? 1 : (lead >> 5) == 0x6 ? 2 : (lead >> 4) == 0xE ? 3 : (lead >> 3) == 0x1E ? 4 : 0;
+                if (n == 0 || i + n > text.size()) [[unlikely]] return expected::cold_err(serial_error::InvalidValue);
+                for (usize k = 1; k < n; ++k)
+                    if ((p[i + k] & 0xC0) != 0x80) [[unlikely]] return expected::cold_err(serial_error::InvalidValue);
+                switch (n) {
+                    case 1: out.push(static_cast<char>(lead)); break;
+                    case 2: out.push(strings::utf8_char(std::array<u8, 2>{p[i], p[i + 1]})); break;
+                    case 3: out.push(strings::utf8_char(std::array<u8, 3>{p[i], p[i + 1], p[i + 2]})); break;
+                    default: out.push(strings::utf8_char(p[i], p[i + 1], p[i + 2], p[i + 3])); break;
+                }
+                i += n;
+            }
+            return expected::ok(std::move(out));
+        }
+    };
+
+    template<>
+    struct ORC_API serializer<time::time> {
+        static constexpr bool BULK = serializer<i64>::BULK && sizeof(time::time) == sizeof(i64);
+        static auto write(writer& w, const time::time value) -> void { w.write_raw(value.raw_value()); }
+        static auto read(reader& r) -> expected::expected<time::time, serial_error> {
+            ORC_TRY(seconds, r.read_raw<i64>())
+            return expected::ok(time::time(seconds));
+        }
+    };
+
+    template<>
+    struct ORC_API serializer<floating::rfloat> {
+        static auto write(writer& w, const floating::rfloat value) -> void { w.write_raw(value.raw()); }
+        static auto read(reader& r) -> expected::expected<floating::rfloat, serial_error> {
+            ORC_TRY(raw, r.read_raw<i64>())
+            if (raw > floating::rfloat::MAX_RAW || raw < -floating::rfloat::MAX_RAW) [[unlikely]]
+                return expected::cold_err(serial_error::InvalidValue);
+            return expected::ok(floating::rfloat::from_raw(raw));
+        }
+    };
+
+    template<serializable T>
+    struct ORC_API serializer<optional::optional<T>> {
+        static auto write(writer& w, const optional::optional<T>& value) -> void {
+            w.write_tag(value.is_some() ? 1 : 0);
+            if (value.is_some()) serializer<T>::write(w, *value);
+        }
+        static auto read(reader& r) -> expected::expected<optional::optional<T>, serial_error> {
+            ORC_TRY(tag, r.read_tag())
+            if (tag == 0) return expected::ok(optional::optional<T>());
+            if (tag != 1) [[unlikely]] return expected::cold_err(serial_error::InvalidTag);
+            ORC_TRY(value, serializer<T>::read(r))
+            return expected::ok(optional::optional<T>(optional::some(std::move(value))));
+        }
+    };
+
+    /// `expected` can be neither moved nor default constructed, so it is decoded into an existing value
+    /// with `reader::read_into` instead of through `read`
+    template<serializable T, serializable E>
+    struct ORC_API serializer<expected::expected<T, E>> {
+        static auto write(writer& w, const expected::expected<T, E>& value) -> void {
+            w.write_tag(value.is_ok() ? 0 : 1);
+            if (value.is_ok()) serializer<T>::write(w, value.get_ok());
+            else serializer<E>::write(w, value.get_err());
+        }
+        static auto read_into(reader& r, expected::expected<T, E>& out) -> expected::expected<bool, serial_error> {
+            ORC_TRY(tag, r.read_tag())
+            if (tag == 0) {
+                ORC_TRY(value, serializer<T>::read(r))
+                out = expected::ok(std::move(value));
+                return expected::ok(true);
+            }
+            if (tag != 1) [[unlikely]] return expected::cold_err(serial_error::InvalidTag);
+            ORC_TRY(error, serializer<E>::read(r))
+            out = expected::err(std::move(error));
+            return expected::ok(false);
+        }
+    };
+}
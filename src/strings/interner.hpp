@@ -0,0 +1,213 @@
+#pragma once
+
+#include <orc_export.hpp>
+#include <ordefs.hpp>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <compare>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <ostream>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+#include "concurrent_queue.hpp"
+#include "flat_hash_map.hpp"
+#include "format.hpp"
+#include "hash.hpp"
+#include "optional.hpp"
+
+using namespace orc::core::defines;
+
+namespace orc::strings {
+
+    /// arena record of one interned string, the text follows the header
+    struct ORC_API _symbol_entry {
+        u32 id;
+        u32 len;
+
+        [[nodiscard]] auto text() const noexcept -> std::string_view { return {reinterpret_cast<const char*>(this + 1), len}; }
+    };
+
+    /// handle to an interned string. compares and hashes by id, the text is read straight from the arena
+    class ORC_API symbol {
+    public:
+        static constexpr u32 NONE = (std::numeric_limits<u32>::max)();
+
+        constexpr symbol() = default;
+        explicit constexpr symbol(const _symbol_entry* entry) noexcept : entry(entry) {}
+
+        [[nodiscard]] constexpr auto is_valid() const noexcept -> bool { return entry != nullptr; }
+        /// dense id in interning order, `NONE` for the default symbol
+        [[nodiscard]] constexpr auto id() const noexcept -> u32 { return entry ? entry->id : NONE; }
+        [[nodiscard]] auto view() const noexcept -> std::string_view { return entry ? entry->text() : std::string_view{}; }
+        [[nodiscard]] constexpr auto size() const noexcept -> usize { return entry ? entry->len : 0; }
+
+        [[nodiscard]] constexpr auto operator==(const symbol& other) const noexcept -> bool { return entry == other.entry; }
+        [[nodiscard]] constexpr auto operator<=>(const symbol& other) const noexcept -> std::strong_ordering { return id() <=> other.id(); }
+        auto hash(hash::hasher& state) const noexcept -> void { state.write(id()); }
+
+        auto format_to(format::sink& out) const -> void { out.write(view()); }
+        friend auto operator<<(std::ostream& os, const symbol& sym) -> std::ostream& { return os << sym.view(); }
+
+    private:
+        const _symbol_entry* entry = nullptr;
+    };
+
+    /// bump allocator for entries, blocks are never moved or freed before the interner
+    class ORC_API _intern_arena {
+    public:
+        static constexpr usize BLOCK = 64 * 1024;
+
+        /// entry for `str`, its id is filled in once one is claimed
+        [[nodiscard]] auto make(const std::string_view str) -> _symbol_entry* {
+            const usize need = (sizeof(_symbol_entry) + str.size() + alignof(_symbol_entry) - 1) & ~(alignof(_symbol_entry) - 1);
+            if (need > capacity - used) {
+                const usize size = std::max<usize>(BLOCK, need);
+                blocks.push_back(std::make_unique<std::byte[]>(size));
+                used = 0;
+                capacity = size;
+                reserved += size;
+            }
+            std::byte* at = blocks.back().get() + used;
+            used += need;
+            auto* entry = ::new (at) _symbol_entry{symbol::NONE, static_cast<u32>(str.size())};
+            std::memcpy(entry + 1, str.data(), str.size());
+            return entry;
+        }
+        [[nodiscard]] auto bytes() const noexcept -> usize { return reserved; }
+
+    private:
+        std::vector<std::unique_ptr<std::byte[]>> blocks;
+        usize used = 0;
+        usize capacity = 0;
+        usize reserved = 0;
+    };
+
+    /// thread-safe string interner. strings are spread over `SHARDS` independently locked tables by hash,
+    /// lookups of strings already present take only a shared lock. ids are dense, and `resolve` reads
+    /// a lock-free segmented table, so neither direction copies text
+    class ORC_API interner {
+    public:
+        static constexpr usize SHARDS = 64;
+
+        interner() = default;
+        interner(const interner&) = delete;
+        auto operator=(const interner&) -> interner& = delete;
+        ~interner() {
+            for (auto& segment : segments) delete[] segment.load(std::memory_order_relaxed);
+        }
+
+        /// process-wide interner
+        [[nodiscard]] static auto global() -> interner& {
+            static interner instance;
+            return instance;
+        }
+
+        /// symbol of `str`, added on first sight. throws `std::length_error` past 2^32 - 1 strings or bytes
+        [[nodiscard]] auto intern(const std::string_view str) -> symbol {
+            _shard& shard = shard_of(str);
+            {
+                const std::shared_lock read(shard.lock);
+                if (const auto* entry = shard.map.find(str); entry != nullptr) return symbol(*entry);
+            }
+            if (str.size() >= symbol::NONE) throw std::length_error("string too long to intern");
+            const std::unique_lock write(shard.lock);
+            if (const auto* entry = shard.map.find(str); entry != nullptr) return symbol(*entry);
+            // everything that can throw runs before the id is claimed, so a failure neither burns an id
+            // nor publishes a symbol that `resolve` finds but the map doesn't
+            shard.map.reserve(shard.map.size() + 1);
+            _symbol_entry* entry = shard.arena.make(str);
+            u32 id = count.load(std::memory_order_relaxed);
+            do {
+                if (id == symbol::NONE) throw std::length_error("interner is full");
+                (void)slot(id); // allocates the segment of `id` up front
+            } while (!count.compare_exchange_weak(id, id + 1, std::memory_order_relaxed));
+            entry->id = id;
+            shard.map.insert(entry->text(), entry);
+            slot(id).store(entry, std::memory_order_release);
+            return symbol(entry);
+        }
+        /// symbol of `str` if it was interned
+        [[nodiscard]] auto find(const std::string_view str) const -> orc::optional::optional<symbol> {
+            const _shard& shard = shard_of(str);
+            const std::shared_lock read(shard.lock);
+            if (const auto* entry = shard.map.find(str); entry != nullptr) return orc::optional::some(symbol(*entry));
+            return orc::optional::none;
+        }
+        /// symbol with the given id, `none` for ids not handed out yet
+        [[nodiscard]] auto resolve(const u32 id) const -> orc::optional::optional<symbol> {
+            if (id >= count.load(std::memory_order_acquire)) return orc::optional::none;
+            const auto [segment, offset] = locate(id);
+            const auto* entries = segments[segment].load(std::memory_order_acquire);
+            if (entries == nullptr) return orc::optional::none;
+            const _symbol_entry* entry = entries[offset].load(std::memory_order_acquire);
+            if (entry == nullptr) return orc::optional::none;
+            return orc::optional::some(symbol(entry));
+        }
+
+        /// number of interned strings
+        [[nodiscard]] auto size() const noexcept -> usize { return count.load(std::memory_order_acquire); }
+        /// bytes reserved by the text arenas
+        [[nodiscard]] auto arena_bytes() const -> usize {
+            usize total = 0;
+            for (const auto& shard : shards) {
+                const std::shared_lock read(shard.lock);
+                total += shard.arena.bytes();
+            }
+            return total;
+        }
+
+    private:
+        /// ids live in segments of `SEGMENT_BASE << s` slots, enough of them for every `u32`
+        static constexpr usize SEGMENT_BASE = 1024;
+        static constexpr usize SEGMENTS = 23;
+        using slot_t = std::atomic<const _symbol_entry*>;
+
+        struct alignas(containers::CACHE_LINE) _shard {
+            mutable std::shared_mutex lock;
+            containers::flat_hash_map<std::string_view, const _symbol_entry*> map;
+            _intern_arena arena;
+        };
+
+        std::array<_shard, SHARDS> shards;
+        std::array<std::atomic<slot_t*>, SEGMENTS> segments{};
+        std::atomic<u32> count{0};
+
+        [[nodiscard]] static auto shard_index(const std::string_view str) noexcept -> usize {
+            // the top bits, the tables themselves use the low ones
+            return static_cast<usize>(hash::hash_bytes(str) >> (64 - std::countr_zero(SHARDS)));
+        }
+        [[nodiscard]] auto shard_of(const std::string_view str) -> _shard& { return shards[shard_index(str)]; }
+        [[nodiscard]] auto shard_of(const std::string_view str) const -> const _shard& { return shards[shard_index(str)]; }
+
+        [[nodiscard]] static auto locate(const u32 id) noexcept -> std::pair<usize, usize> {
+            const usize segment = static_cast<usize>(std::bit_width(id / SEGMENT_BASE + 1)) - 1;
+            return {segment, id - SEGMENT_BASE * ((usize{1} << segment) - 1)};
+        }
+        [[nodiscard]] auto slot(const u32 id) -> slot_t& {
+            const auto [segment, offset] = locate(id);
+            slot_t* entries = segments[segment].load(std::memory_order_acquire);
+            if (entries == nullptr) {
+                auto* fresh = new slot_t[SEGMENT_BASE << segment]{};
+                if (segments[segment].compare_exchange_strong(entries, fresh, std::memory_order_acq_rel, std::memory_order_acquire)) entries = fresh;
+                else delete[] fresh;
+            }
+            return entries[offset];
+        }
+    };
+}
+
+namespace orc::hash {
+    /// symbols hash their id, no text is read
+    template<>
+    struct ORC_API default_hash<strings::symbol> {
+        [[nodiscard]] auto operator()(const strings::symbol sym) const noexcept -> u64 { return hash_int(sym.id()); }
+    };
+}
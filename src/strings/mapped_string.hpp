@@ -0,0 +1,48 @@
+#pragma once
+
+#include <orc_export.hpp>
+#include <ordefs.hpp>
+#include <checks.hpp>
+#include <container.hpp>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include "hash.hpp"
+#include "mapped_file.hpp"
+
+using namespace orc::core::defines;
+
+namespace orc::strings {
+
+    /// read-only view of a whole file mapped into memory, the text is never copied
+    class ORC_API mapped_string final : public core::container::container<char> {
+    public:
+        explicit mapped_string(const std::string& path) : file(path, core::map_mode::ReadOnly) {}
+
+        [[nodiscard]] constexpr auto size() const noexcept -> usize override { return file.size(); }
+        [[nodiscard]] constexpr auto is_empty() const noexcept -> bool override { return file.size() == 0; }
+        [[nodiscard]] auto get(const usize idx) const -> const char& override {
+            ORC_BOUNDS_CHECK(idx < size(), "index out of range");
+            return data()[idx];
+        }
+        [[nodiscard]] auto operator[](const usize idx) const -> const char& override { return get(idx); }
+        [[nodiscard]] auto get_unchecked(const usize idx) const -> const char& {
+            ORC_DEBUG_CHECK(idx < size(), "index out of range");
+            return data()[idx];
+        }
+
+        [[nodiscard]] auto data() const noexcept -> const char* { return reinterpret_cast<const char*>(file.data()); }
+        [[nodiscard]] auto view() const noexcept -> std::string_view { return {data(), size()}; }
+        auto advise(const core::access_hint hint) const noexcept -> void { file.advise(hint); }
+
+        [[nodiscard]] auto operator==(const std::string_view str) const noexcept -> bool { return view() == str; }
+        auto hash(hash::hasher& state) const noexcept -> void { state.write(view()); }
+
+        auto format_to(format::sink& out) const -> void override { out.write(view()); }
+        auto print(std::ostream& os) const -> void override { os << view(); }
+
+    private:
+        core::mapped_file file;
+    };
+}
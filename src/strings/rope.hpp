@@ -0,0 +1,300 @@
+#pragma once
+
+#include <orc_export.hpp>
+#include <ordefs.hpp>
+#include <checks.hpp>
+#include <algorithm>
+#include <concepts>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "format.hpp"
+#include "rstring.hpp"
+
+using namespace orc::core::defines;
+
+namespace orc::strings {
+
+    /// sink collecting text in chunks which are never moved once written. appends cost one `memcpy`
+    /// into the sink buffer, and the text is made contiguous only once by `build` or `take_string`
+    class ORC_API string_builder final : public format::sink {
+    public:
+        static constexpr usize MIN_CHUNK = 16 * 1024;
+        static constexpr usize MAX_CHUNK = 4 * 1024 * 1024;
+
+        string_builder() = default;
+        ~string_builder() override = default;
+
+        auto append(const std::string_view str) -> string_builder& {
+            write(str);
+            return *this;
+        }
+        auto append(const utf8_char& ch) -> string_builder& {
+            write(ch.bytes());
+            return *this;
+        }
+        template<typename T>
+        requires (!std::convertible_to<const T&, std::string_view>)
+        auto append(const T& value) -> string_builder& {
+            format::format_to(*this, value);
+            return *this;
+        }
+
+        /// bytes written so far
+        [[nodiscard]] auto size_bytes() -> usize {
+            flush();
+            return total;
+        }
+
+        /// the whole text as one orc string, the builder is left empty
+        [[nodiscard]] auto build() -> mutable_u8string<> {
+            flush();
+            mutable_u8string<> out;
+            usize chars = 0;
+            for (const auto& chunk : chunks)
+                for (const char ch : chunk) chars += !_is_utf8_continuation(static_cast<u8>(ch));
+            out.reserve(chars);
+            std::string carry;
+            for (const auto& chunk : chunks) {
+                std::string_view rest = chunk;
+                if (!carry.empty()) {
+                    // a character split between two chunks
+                    const usize width = _utf8_len(static_cast<u8>(carry[0]));
+                    const usize need = std::min<usize>(width - carry.size(), rest.size());
+                    carry.append(rest.substr(0, need));
+                    rest.remove_prefix(need);
+                    if (carry.size() < width) continue;
+                    (void)out.push_utf8(carry);
+                    carry.clear();
+                }
+                carry.assign(rest.substr(out.push_utf8(rest)));
+            }
+            if (!carry.empty()) throw std::invalid_argument("malformed utf-8");
+            clear();
+            return out;
+        }
+        /// the whole text as utf-8 bytes, the builder is left empty
+        [[nodiscard]] auto take_string() -> std::string {
+            flush();
+            std::string out;
+            out.reserve(total);
+            for (const auto& chunk : chunks) out.append(chunk);
+            clear();
+            return out;
+        }
+        auto clear() noexcept -> void {
+            chunks.clear();
+            total = 0;
+        }
+
+    protected:
+        auto consume(std::string_view bytes) -> void override {
+            total += bytes.size();
+            while (!bytes.empty()) {
+                if (chunks.empty() || chunks.back().size() == chunks.back().capacity()) {
+                    chunks.emplace_back();
+                    chunks.back().reserve(std::clamp<usize>(total, MIN_CHUNK, MAX_CHUNK));
+                }
+                std::string& chunk = chunks.back();
+                const usize n = std::min<usize>(bytes.size(), chunk.capacity() - chunk.size());
+                chunk.append(bytes.substr(0, n));
+                bytes.remove_prefix(n);
+            }
+        }
+
+    private:
+        std::vector<std::string> chunks;
+        usize total = 0;
+    };
+
+    /// shared, immutable tree node. leaves hold text, inner nodes only the totals of their subtrees
+    struct ORC_API _rope_node {
+        std::shared_ptr<const _rope_node> left;
+        std::shared_ptr<const _rope_node> right;
+        std::string text;
+        usize bytes = 0;
+        usize chars = 0;
+        u8 height = 0;
+    };
+
+    /// immutable utf-8 text stored as a balanced tree of chunks, indexed by character.
+    /// `concat`, `slice` and `get` are O(log n), results share unchanged subtrees with their inputs
+    class ORC_API rope {
+    public:
+        /// leaves up to this size are merged instead of getting their own node
+        static constexpr usize LEAF_BYTES = 1024;
+
+        rope() = default;
+        /// throws `std::invalid_argument` on malformed utf-8
+        explicit rope(const std::string_view utf8) : root(_from_text(_checked(utf8))) {}
+
+        [[nodiscard]] auto size() const noexcept -> usize { return root ? root->chars : 0; }
+        [[nodiscard]] auto size_bytes() const noexcept -> usize { return root ? root->bytes : 0; }
+        [[nodiscard]] auto is_empty() const noexcept -> bool { return size() == 0; }
+
+        [[nodiscard]] auto get(usize idx) const -> utf8_char {
+            ORC_BOUNDS_CHECK(idx < size(), "index out of range");
+            const _rope_node* node = root.get();
+            while (node->left) {
+                if (idx < node->left->chars) node = node->left.get();
+                else {
+                    idx -= node->left->chars;
+                    node = node->right.get();
+                }
+            }
+            const usize at = _byte_offset(node->text, idx);
+            return utf8_char(std::span<const u8>(reinterpret_cast<const u8*>(node->text.data()) + at,
+                                                 _utf8_len(static_cast<u8>(node->text[at]))));
+        }
+        [[nodiscard]] auto operator[](const usize idx) const -> utf8_char { return get(idx); }
+
+        [[nodiscard]] auto concat(const rope& other) const -> rope { return rope(_join(root, other.root)); }
+        [[nodiscard]] auto append(const std::string_view utf8) const -> rope { return rope(_join(root, _from_text(_checked(utf8)))); }
+        [[nodiscard]] friend auto operator+(const rope& l, const rope& r) -> rope { return l.concat(r); }
+
+        /// characters `[from, to)`
+        [[nodiscard]] auto slice(const usize from, const usize to) const -> rope {
+            if (from > to || to > size()) throw std::out_of_range("slice out of range");
+            auto [head, tail] = _split(root, to);
+            return rope(_split(head, from).second);
+        }
+
+        /// calls `f(std::string_view)` for every chunk of text in order
+        template<typename F>
+        auto for_each_chunk(F&& f) const -> void { _visit(root.get(), f); }
+
+        /// the whole text as one orc string, allocated once
+        [[nodiscard]] auto flatten() const -> mutable_u8string<> {
+            mutable_u8string<> out;
+            out.reserve(size());
+            for_each_chunk([&out](const std::string_view chunk) { (void)out.push_utf8(chunk); });
+            return out;
+        }
+
+        [[nodiscard]] auto operator==(const rope& other) const -> bool {
+            if (size_bytes() != other.size_bytes()) return false;
+            std::string l, r;
+            l.reserve(size_bytes());
+            r.reserve(size_bytes());
+            for_each_chunk([&l](const std::string_view chunk) { l.append(chunk); });
+            other.for_each_chunk([&r](const std::string_view chunk) { r.append(chunk); });
+            return l == r;
+        }
+
+        auto format_to(format::sink& out) const -> void {
+            for_each_chunk([&out](const std::string_view chunk) { out.write(chunk); });
+        }
+        auto print(std::ostream& os) const -> void {
+            format::ostream_sink out(os);
+            format_to(out);
+        }
+        friend auto operator<<(std::ostream& os, const rope& obj) -> std::ostream& {
+            obj.print(os);
+            return os;
+        }
+
+    private:
+        using node_ptr = std::shared_ptr<const _rope_node>;
+        node_ptr root;
+
+        explicit rope(node_ptr root) : root(std::move(root)) {}
+
+        [[nodiscard]] static auto _checked(const std::string_view utf8) -> std::string_view {
+            if (!_is_valid_utf8(utf8)) throw std::invalid_argument("malformed utf-8");
+            return utf8;
+        }
+        [[nodiscard]] static auto _height(const node_ptr& node) noexcept -> i32 { return node ? node->height : -1; }
+        [[nodiscard]] static auto _count_chars(const std::string_view text) noexcept -> usize {
+            usize chars = 0;
+            for (const char ch : text) chars += !_is_utf8_continuation(static_cast<u8>(ch));
+            return chars;
+        }
+        /// byte offset of character `idx` in a leaf, leaves are short so a scan is cheap
+        [[nodiscard]] static auto _byte_offset(const std::string_view text, usize idx) noexcept -> usize {
+            usize at = 0;
+            while (idx > 0) {
+                at += _utf8_len(static_cast<u8>(text[at]));
+                idx--;
+            }
+            return at;
+        }
+
+        [[nodiscard]] static auto _leaf(std::string text) -> node_ptr {
+            if (text.empty()) return nullptr;
+            auto node = std::make_shared<_rope_node>();
+            node->chars = _count_chars(text);
+            node->bytes = text.size();
+            node->text = std::move(text);
+            return node;
+        }
+        [[nodiscard]] static auto _node(node_ptr l, node_ptr r) -> node_ptr {
+            auto node = std::make_shared<_rope_node>();
+            node->bytes = l->bytes + r->bytes;
+            node->chars = l->chars + r->chars;
+            node->height = static_cast<u8>(std::max<u8>(l->height, r->height) + 1);
+            node->left = std::move(l);
+            node->right = std::move(r);
+            return node;
+        }
+        /// balanced tree over `text` cut into leaves at character boundaries
+        [[nodiscard]] static auto _from_text(const std::string_view text) -> node_ptr {
+            if (text.size() <= LEAF_BYTES) return _leaf(std::string(text));
+            usize mid = text.size() / 2;
+            while (mid > 0 && _is_utf8_continuation(static_cast<u8>(text[mid]))) mid--;
+            if (mid == 0) mid = text.size() / 2;
+            return _node(_from_text(text.substr(0, mid)), _from_text(text.substr(mid)));
+        }
+
+        /// avl rotations for children whose heights differ by at most 2
+        [[nodiscard]] static auto _balance(node_ptr l, node_ptr r) -> node_ptr {
+            if (_height(l) > _height(r) + 1) {
+                if (_height(l->left) >= _height(l->right)) return _node(l->left, _node(l->right, std::move(r)));
+                return _node(_node(l->left, l->right->left), _node(l->right->right, std::move(r)));
+            }
+            if (_height(r) > _height(l) + 1) {
+                if (_height(r->right) >= _height(r->left)) return _node(_node(std::move(l), r->left), r->right);
+                return _node(_node(std::move(l), r->left->left), _node(r->left->right, r->right));
+            }
+            return _node(std::move(l), std::move(r));
+        }
+        /// concatenation in O(|height(l) - height(r)|), descending the taller side
+        [[nodiscard]] static auto _join(const node_ptr& l, const node_ptr& r) -> node_ptr {
+            if (!l) return r;
+            if (!r) return l;
+            if (!l->left && !r->left && l->bytes + r->bytes <= LEAF_BYTES) return _leaf(l->text + r->text);
+            if (_height(l) > _height(r) + 1) return _balance(l->left, _join(l->right, r));
+            if (_height(r) > _height(l) + 1) return _balance(_join(l, r->left), r->right);
+            return _node(l, r);
+        }
+        /// characters before `idx` and from `idx` on
+        [[nodiscard]] static auto _split(const node_ptr& node, const usize idx) -> std::pair<node_ptr, node_ptr> {
+            if (!node) return {nullptr, nullptr};
+            if (idx == 0) return {nullptr, node};
+            if (idx >= node->chars) return {node, nullptr};
+            if (!node->left) {
+                const usize at = _byte_offset(node->text, idx);
+                return {_leaf(node->text.substr(0, at)), _leaf(node->text.substr(at))};
+            }
+            if (idx <= node->left->chars) {
+                auto [l, r] = _split(node->left, idx);
+                return {std::move(l), _join(r, node->right)};
+            }
+            auto [l, r] = _split(node->right, idx - node->left->chars);
+            return {_join(node->left, l), std::move(r)};
+        }
+        template<typename F>
+        static auto _visit(const _rope_node* node, F& f) -> void {
+            if (!node) return;
+            if (!node->left) {
+                f(std::string_view(node->text));
+                return;
+            }
+            _visit(node->left.get(), f);
+            _visit(node->right.get(), f);
+        }
+    };
+}
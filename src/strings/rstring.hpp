@@ -1,19 +1,45 @@
 #pragma once
 
 #include <array>
+#include <cstring>
 #include <orc_export.hpp>
 #include <ordefs.hpp>
+#include <checks.hpp>
 #include <stdexcept>
 #include <container.hpp>
 #include <memory>
 #include <ostream>
+#include <span>
 #include <string>
+#include <string_view>
+#include <utility>
+#include "format.hpp"
+#include "hash.hpp"
+#include "instrument.hpp"
 
 using namespace orc::core::defines;
 
 namespace orc::strings {
         using ascii_char = char;
 
+        /// length of the utf-8 sequence starting with `lead`, 0 for a continuation or invalid byte
+        [[nodiscard]] constexpr auto _utf8_len(const u8 lead) noexcept -> usize {
+            return lead < 0x80 ? 1 : (lead >> 5) == 0x6 ? 2 : (lead >> 4) == 0xE ? 3 : (lead >> 3) == 0x1E ? 4 : 0;
+        }
+        [[nodiscard]] constexpr auto _is_utf8_continuation(const u8 byte) noexcept -> bool { return (byte & 0xC0) == 0x80; }
+        /// every sequence has a valid lead byte and all of its continuation bytes
+        [[nodiscard]] constexpr auto _is_valid_utf8(const std::string_view text) noexcept -> bool {
+            usize i = 0;
+            while (i < text.size()) {
+                const usize n = _utf8_len(static_cast<u8>(text[i]));
+                if (n == 0 || i + n > text.size()) return false;
+                for (usize k = 1; k < n; ++k)
+                    if (!_is_utf8_continuation(static_cast<u8>(text[i + k]))) return false;
+                i += n;
+            }
+            return true;
+        }
+
         class ORC_API utf8_char {
         public:
             explicit utf8_char(const ascii_char ascii) : data{static_cast<u8>(ascii), 0, 0, 0}, actual_len(1) {}
@@ -25,8 +51,13 @@ namespace orc::strings {
                     this->data[i] = data[i];
                 actual_len = data.size();
             }
+            explicit utf8_char(const std::span<const u8> bytes) {
+                if (bytes.size() > 4) throw std::invalid_argument("utf-8 character is at most 4 bytes");
+                for (usize i = 0; i < bytes.size(); ++i) data[i] = bytes[i];
+                actual_len = bytes.size();
+            }
             ~utf8_char() = default;
-            template<usize N>
+            template<std::size_t N>
             requires (N <= 4)
             explicit utf8_char(const std::array<u8, N>& dat) : data{0, 0, 0, 0}, actual_len(N) {
                 for (usize i = 0; i < N; ++i) data[i] = dat[i];
@@ -34,7 +65,12 @@ namespace orc::strings {
 
             [[nodiscard]] constexpr auto is_ascii() const noexcept -> bool { return actual_len == 1; }
             [[nodiscard]] constexpr explicit operator char() const noexcept { return static_cast<char>(data[0]); }
+            /// utf-8 encoding of the character
+            [[nodiscard]] constexpr auto bytes() const noexcept -> std::span<const u8> { return {data.data(), actual_len}; }
 
+            [[nodiscard]] constexpr auto operator==(const utf8_char&) const noexcept -> bool = default;
+            auto hash(hash::hasher& state) const noexcept -> void { state.write(bytes()); }
+            auto format_to(format::sink& out) const -> void { out.write(bytes()); }
 
             friend auto operator<<(std::ostream& os, const utf8_char& ch) -> std::ostream& {
                 os.write(reinterpret_cast<const char*>(ch.data.data()), static_cast<std::streamsize>(ch.actual_len));
@@ -54,59 +90,99 @@ namespace orc::strings {
                 const usize len = std::strlen(str);
                 reallocate_and_grow(len);
                 for (usize i = 0; i < len; ++i)
-                    alloc_traits::construct(allocator, data + i, str[i]);
+                    alloc_traits::construct(allocator, buffer + i, str[i]);
                 this->len = len;
+                ORC_RECORD(mutable_u8string, Construction, len);
             }
             ~mutable_u8string() override {
-                destroy_range(data, len);
-                deallocate(data, cap);
+                destroy_range(buffer, len);
+                deallocate(buffer, cap);
             }
 
             mutable_u8string(const mutable_u8string&) = delete;
             auto operator=(const mutable_u8string&) -> mutable_u8string& = delete;
 
-            mutable_u8string(mutable_u8string&&) = default;
-            auto operator=(mutable_u8string&&) -> mutable_u8string& = default;
+            mutable_u8string(mutable_u8string&& other) noexcept
+                : len(std::exchange(other.len, 0)), cap(std::exchange(other.cap, 0)),
+                  allocator(std::move(other.allocator)), buffer(std::exchange(other.buffer, nullptr)) {}
+            auto operator=(mutable_u8string&& other) noexcept -> mutable_u8string& {
+                if (this == &other) return *this;
+                destroy_range(buffer, len);
+                deallocate(buffer, cap);
+                len = std::exchange(other.len, 0);
+                cap = std::exchange(other.cap, 0);
+                allocator = std::move(other.allocator);
+                buffer = std::exchange(other.buffer, nullptr);
+                return *this;
+            }
 
             auto operator=(const ascii_char* str) -> mutable_u8string& {
                 const usize len = std::strlen(str);
-                if (len > 0) destroy_range(data, this->len);
+                if (len > 0) destroy_range(buffer, this->len);
                 if (cap < len) reallocate_and_grow(len);
                 for (usize i = 0; i < len; ++i)
-                    alloc_traits::construct(allocator, data + i, static_cast<utf8_char>(str[i]));
+                    alloc_traits::construct(allocator, buffer + i, static_cast<utf8_char>(str[i]));
                 this->len = len;
+                ORC_RECORD(mutable_u8string, Construction, len);
                 return *this;
             }
 
-            constexpr auto print(std::ostream& os) const -> void override {
-                for (usize i = 0; i < len; ++i)
-                    os << data[i];
+            auto format_to(format::sink& out) const -> void override {
+                // re-encoded into a local run first, one `write` per character costs more than the copy itself.
+                // every character stores 4 bytes, so a fixed-size copy is fine and only the length varies
+                u8 run[256];
+                usize used = 0;
+                for (usize i = 0; i < len; ++i) {
+                    if (used > sizeof(run) - 4) {
+                        out.write(std::span<const u8>{run, used});
+                        used = 0;
+                    }
+                    const auto bytes = buffer[i].bytes();
+                    std::memcpy(run + used, bytes.data(), 4);
+                    used += bytes.size();
+                }
+                out.write(std::span<const u8>{run, used});
+            }
+            auto print(std::ostream& os) const -> void override {
+                format::ostream_sink out(os);
+                format_to(out);
             }
 
             [[nodiscard]] constexpr auto size() const noexcept -> usize override { return len; }
             [[nodiscard]] constexpr auto is_empty() const noexcept -> bool override { return len == 0; }
+            [[nodiscard]] constexpr auto data() noexcept -> utf8_char* { return buffer; }
+            [[nodiscard]] constexpr auto data() const noexcept -> const utf8_char* { return buffer; }
+            [[nodiscard]] constexpr auto as_span() noexcept -> std::span<utf8_char> { return {buffer, len}; }
+            [[nodiscard]] constexpr auto as_span() const noexcept -> std::span<const utf8_char> { return {buffer, len}; }
+            /// pointer iterators over the characters, so the string models `std::ranges::contiguous_range`
+            [[nodiscard]] constexpr auto begin() noexcept -> utf8_char* { return buffer; }
+            [[nodiscard]] constexpr auto end() noexcept -> utf8_char* { return buffer + len; }
+            [[nodiscard]] constexpr auto begin() const noexcept -> const utf8_char* { return buffer; }
+            [[nodiscard]] constexpr auto end() const noexcept -> const utf8_char* { return buffer + len; }
             [[nodiscard]] constexpr auto get(const usize idx) const -> const utf8_char& override {
-                if (idx >= len) throw std::out_of_range("index out of range");
-                return data[idx];
+                ORC_BOUNDS_CHECK(idx < len, "index out of range");
+                return buffer[idx];
             }
             [[nodiscard]] constexpr auto get(const usize idx) -> utf8_char& override {
-                if (idx >= len) throw std::out_of_range("index out of range");
-                return data[idx];
+                ORC_BOUNDS_CHECK(idx < len, "index out of range");
+                return buffer[idx];
             }
             constexpr auto set(const usize idx, const utf8_char& ch) -> void override {
-                if (idx >= len) throw std::out_of_range("index out of range");
-                data[idx] = ch;
+                ORC_BOUNDS_CHECK(idx < len, "index out of range");
+                buffer[idx] = ch;
             }
 
             [[nodiscard]] constexpr auto reversed() const -> mutable_u8string {
                 mutable_u8string result;
+                result.reserve(len);
                 for (isize i = len - 1; i >= 0; --i)
-                    result.push(data[i]);
+                    result.push(buffer[i]);
                 return result;
             }
 
             [[nodiscard]] constexpr auto into_reversed() -> mutable_u8string {
                 mutable_u8string result;
+                result.reserve(len);
                 for (usize _i = 0; _i < len; ++_i)
                     result.push(pop());
                 return result;
@@ -114,39 +190,115 @@ namespace orc::strings {
 
             [[nodiscard]] constexpr auto operator[](const usize idx) const -> const utf8_char& override { return get(idx); }
             [[nodiscard]] constexpr auto operator[](const usize idx) -> utf8_char& override { return get(idx); }
+            /// unchecked `get`, verified only at `ORC_CHECKS` level 2
+            [[nodiscard]] constexpr auto get_unchecked(const usize idx) const -> const utf8_char& {
+                ORC_DEBUG_CHECK(idx < len, "index out of range");
+                return buffer[idx];
+            }
+            [[nodiscard]] constexpr auto get_unchecked(const usize idx) -> utf8_char& {
+                ORC_DEBUG_CHECK(idx < len, "index out of range");
+                return buffer[idx];
+            }
 
-            [[nodiscard]] constexpr auto top() -> utf8_char& override { return data[len - 1]; }
-            [[nodiscard]] constexpr auto top() const -> const utf8_char& override { return data[len - 1]; }
+            [[nodiscard]] constexpr auto top() -> utf8_char& override { return buffer[len - 1]; }
+            [[nodiscard]] constexpr auto top() const -> const utf8_char& override { return buffer[len - 1]; }
 
             [[nodiscard]] constexpr auto is_ascii() const -> bool {
                 for (usize i = 0; i < len; ++i)
-                    if constexpr (!data[i].is_ascii()) return false;
+                    if constexpr (!buffer[i].is_ascii()) return false;
                 return true;
             }
 
             constexpr auto push(const utf8_char& ch) -> void override {
                 if (len == cap)
                     reallocate_and_grow(cap + 1);
-                data[len++] = ch;
+                buffer[len++] = ch;
+                ORC_RECORD(mutable_u8string, Construction, 1);
             }
             constexpr auto push(const char ch) -> void {
                 if (len == cap)
                     reallocate_and_grow(cap + 1);
-                alloc_traits::construct(allocator, data + len, std::move(ch));
+                alloc_traits::construct(allocator, buffer + len, std::move(ch));
                 len++;
+                ORC_RECORD(mutable_u8string, Construction, 1);
+            }
+            /// room for at least `n` characters without reallocating
+            auto reserve(const usize n) -> void {
+                if (n > cap) reallocate_and_grow(n);
+            }
+            /// appends the characters encoded in `text` with at most one reallocation. a character cut off at the end
+            /// is left alone and the number of bytes used is returned, so chunked input can be fed piece by piece.
+            /// throws `std::invalid_argument` on malformed utf-8
+            auto push_utf8(const std::string_view text) -> usize {
+                const auto* p = reinterpret_cast<const u8*>(text.data());
+                usize chars = 0;
+                for (usize i = 0; i < text.size(); ++i) chars += !_is_utf8_continuation(p[i]);
+                reserve(len + chars);
+                [[maybe_unused]] const usize before = len;
+                usize i = 0;
+                while (i < text.size()) {
+                    if (p[i] < 0x80) {
+                        alloc_traits::construct(allocator, buffer + len++, static_cast<ascii_char>(p[i++]));
+                        continue;
+                    }
+                    const usize n = _utf8_len(p[i]);
+                    if (n == 0) throw std::invalid_argument("malformed utf-8");
+                    if (i + n > text.size()) break;
+                    for (usize k = 1; k < n; ++k)
+                        if (!_is_utf8_continuation(p[i + k])) throw std::invalid_argument("malformed utf-8");
+                    alloc_traits::construct(allocator, buffer + len, utf8_char(std::span<const u8>(p + i, n)));
+                    len++;
+                    i += n;
+                }
+                ORC_RECORD(mutable_u8string, Construction, len - before);
+                return i;
             }
             [[nodiscard]] constexpr auto pop() -> utf8_char override {
-                if (len == 0) throw std::out_of_range("empty string");
-                const utf8_char tmp = data[len - 1];
-                alloc_traits::destroy(allocator, &data[len - 1]);
+                if (len == 0) [[unlikely]] core::checks::_fail_out_of_range("empty string");
+                const utf8_char tmp = buffer[len - 1];
+                alloc_traits::destroy(allocator, &buffer[len - 1]);
                 len--;
                 return tmp;
             }
 
+            [[nodiscard]] constexpr auto operator==(const mutable_u8string& other) const noexcept -> bool {
+                if (len != other.len) return false;
+                for (usize i = 0; i < len; ++i)
+                    if (buffer[i] != other.buffer[i]) return false;
+                return true;
+            }
+            /// compares the utf-8 encoding of the string with `str`
+            [[nodiscard]] constexpr auto operator==(const std::string_view str) const noexcept -> bool {
+                usize pos = 0;
+                for (usize i = 0; i < len; ++i) {
+                    const auto bytes = buffer[i].bytes();
+                    if (str.size() - pos < bytes.size()) return false;
+                    for (const u8 b : bytes)
+                        if (static_cast<u8>(str[pos++]) != b) return false;
+                }
+                return pos == str.size();
+            }
+            /// hashes the utf-8 encoding, so equal to `hash::hash_bytes` of the same text
+            auto hash(hash::hasher& state) const noexcept -> void {
+                // characters are re-encoded in chunks so the hasher sees a few large writes
+                u8 chunk[64];
+                usize used = 0;
+                for (usize i = 0; i < len; ++i) {
+                    const auto bytes = buffer[i].bytes();
+                    if (used + bytes.size() > sizeof(chunk)) {
+                        state.write(std::span<const u8>{chunk, used});
+                        used = 0;
+                    }
+                    std::memcpy(chunk + used, bytes.data(), bytes.size());
+                    used += bytes.size();
+                }
+                state.write(std::span<const u8>{chunk, used});
+            }
+
             [[nodiscard]] constexpr explicit operator std::string() const requires(is_ascii()) {
                 std::string out;
                 for (usize i = 0; i < len; ++i)
-                    out.push_back(static_cast<char>(data[i]));
+                    out.push_back(static_cast<char>(buffer[i]));
                 return out;
             }
 
@@ -154,11 +306,12 @@ namespace orc::strings {
             usize len = 0;
             usize cap = 0;
             Alloc allocator;
-            utf8_char* data = nullptr;
+            utf8_char* buffer = nullptr;
             using alloc_traits = std::allocator_traits<Alloc>;
 
             auto allocate(usize n) -> utf8_char* {
                 if (n == 0) return nullptr;
+                ORC_RECORD(mutable_u8string, Allocation, 1);
                 return alloc_traits::allocate(allocator, n);
             }
             auto deallocate(utf8_char* p, const usize n) -> void {
@@ -174,7 +327,7 @@ namespace orc::strings {
                 utf8_char* new_data = allocate(target);
                 usize moved = 0;
                 try {
-                    std::uninitialized_move(data, data + len, new_data);
+                    std::uninitialized_move(buffer, buffer + len, new_data);
                     moved = len;
                 } catch (...) {
                     destroy_range(new_data, moved);
@@ -182,10 +335,14 @@ namespace orc::strings {
                     throw;
                 }
 
-                destroy_range(data, len);
-                deallocate(data, cap);
+                if (buffer != nullptr) {
+                    ORC_RECORD(mutable_u8string, Reallocation, 1);
+                    ORC_RECORD(mutable_u8string, BytesMoved, len * sizeof(utf8_char));
+                }
+                destroy_range(buffer, len);
+                deallocate(buffer, cap);
 
-                data = new_data;
+                buffer = new_data;
                 cap = target;
             }
 
@@ -0,0 +1,73 @@
+#include <iostream>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "assert.hpp"
+#include "concurrent_queue.hpp"
+
+using namespace orc;
+using assert::assert_eq;
+
+namespace {
+    auto test_spsc_queue() -> void {
+        containers::spsc_queue<int, 16> q;
+        int none[1];
+        assert_eq(q.push_batch(std::span<const int>{}), 0u);
+        assert_eq(q.pop_batch(std::span<int>(none, 0)), 0u);
+        const int values[] = {1, 2, 3};
+        assert_eq(q.push_batch(values), 3u);
+        assert_eq(q.pop_batch(std::span<int>{}), 0u);
+        int out[4];
+        assert_eq(q.pop_batch(out), 3u);
+        assert_eq(out[2], 3);
+    }
+
+    auto test_mpmc_queue() -> void {
+        containers::mpmc_queue<int, 16> q;
+        // empty batches must return at once on an empty, a non-empty and a full queue
+        assert_eq(q.push_batch(std::span<const int>{}), 0u);
+        assert_eq(q.pop_batch(std::span<int>{}), 0u);
+        assert::assert(q.try_push(7));
+        assert_eq(q.pop_batch(std::span<int>{}), 0u);
+        assert_eq(q.push_batch(std::span<const int>{}), 0u);
+        for (int i = 0; i < 15; ++i) assert::assert(q.try_push(i));
+        assert::assert(!q.try_push(0));
+        assert_eq(q.push_batch(std::span<const int>{}), 0u);
+        int out[32];
+        assert_eq(q.pop_batch(out), 16u);
+        assert_eq(out[0], 7);
+        assert::assert(q.try_pop().is_none());
+
+        // every value pushed by the producers is popped exactly once
+        constexpr int PER_THREAD = 20000;
+        containers::mpmc_queue<int, 64> shared;
+        std::vector<int> seen(2 * PER_THREAD, 0);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 2; ++t)
+            threads.emplace_back([&shared, t] {
+                for (int i = 0; i < PER_THREAD; ++i)
+                    while (!shared.try_push(t * PER_THREAD + i)) std::this_thread::yield();
+            });
+        std::atomic<int> popped{0};
+        for (int t = 0; t < 2; ++t)
+            threads.emplace_back([&shared, &seen, &popped] {
+                int batch[8];
+                while (popped.load() < 2 * PER_THREAD) {
+                    const usize n = shared.pop_batch(batch);
+                    for (usize i = 0; i < n; ++i) seen[batch[i]]++;
+                    popped += static_cast<int>(n);
+                    if (n == 0) std::this_thread::yield();
+                }
+            });
+        for (auto& t : threads) t.join();
+        for (const int count : seen) assert_eq(count, 1);
+    }
+}
+
+auto main() -> int {
+    test_spsc_queue();
+    test_mpmc_queue();
+    std::cout << "all tests passed\n";
+    return 0;
+}
@@ -1,5 +1,6 @@
 #pragma once
-#include <format>
+#include <compare>
+#include <string_view>
 #include <iostream>
 #include <ordefs.hpp>
 #include <orc_export.hpp>
@@ -7,7 +8,11 @@
 #include <ostream>
 
 #include "arithmetic.hpp"
+#include "divisor.hpp"
 #include "expected.hpp"
+#include "format.hpp"
+#include "hash.hpp"
+#include "static_vector.hpp"
 #include "winapi.hpp"
 using namespace orc::core::defines;
 using namespace orc::expected;
@@ -33,28 +38,37 @@ namespace orc::time {
 
     ORC_API constexpr i64 SECONDS_PER_DAY = 60 * 60 * 24;
     ORC_API constexpr i64 SECONDS_PER_HOUR = 3600;
+    ORC_API constexpr i64 SECONDS_PER_MINUTE = 60;
+    ORC_API constexpr divisor<i64> DAY_DIVISOR{SECONDS_PER_DAY};
+    ORC_API constexpr divisor<i64> HOUR_DIVISOR{SECONDS_PER_HOUR};
+    ORC_API constexpr divisor<i64> MINUTE_DIVISOR{SECONDS_PER_MINUTE};
     static constexpr auto is_leap(const i32 year) -> bool {
         return (year % 400 == 0) || (year % 4 == 0 && year % 100 != 0);
     }
-    static constexpr auto days_in_month(const i32 year, const i32 month) -> u8 {
-        switch (month) {
-            case 1:
-            case 3:
-            case 5:
-            case 7:
-            case 8:
-            case 10:
-            case 12:
-                return 31;
-            case 4:
-            case 6:
-            case 9:
-            case 11:
-                return 30;
-            case 2:
-                return is_leap(year) ? 29 : 28;
-            default: return 0;
+
+    /// month tables are built at compile time and indexed by `month - 1`
+    ORC_API constexpr containers::static_vector<u8, 12> DAYS_IN_MONTH{31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    ORC_API constexpr containers::static_vector<std::string_view, 12> MONTH_NAMES{
+        "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec",
+    };
+    /// days before the first of each month in a common year
+    ORC_API constexpr containers::static_vector<u16, 12> DAYS_BEFORE_MONTH = [] {
+        containers::static_vector<u16, 12> table;
+        u16 days = 0;
+        for (usize m = 0; m < DAYS_IN_MONTH.size(); ++m) {
+            table.push(days);
+            days += DAYS_IN_MONTH[m];
         }
+        return table;
+    }();
+    static_assert(DAYS_BEFORE_MONTH.top() + DAYS_IN_MONTH.top() == 365);
+
+    static constexpr auto days_in_month(const i32 year, const i32 month) -> u8 {
+        if (month < 1 || month > 12) return 0;
+        return static_cast<u8>(DAYS_IN_MONTH[month - 1] + (month == 2 && is_leap(year)));
+    }
+    static constexpr auto days_before_month(const i32 year, const i32 month) -> i64 {
+        return DAYS_BEFORE_MONTH[month - 1] + (month > 2 && is_leap(year));
     }
     static constexpr auto leaps_up_to(const i32 y) -> i64 {
         return static_cast<i64>(y) / 4 - static_cast<i64>(y) / 100 + static_cast<i64>(y) / 400;
@@ -90,21 +104,12 @@ namespace orc::time {
                                                 const u8 min,
                                                 const u8 sec
         ) -> ::expected<time, time_error> {
-            if (month == 0 || month > 12)
-                return err(time_error::RangeError);
-            u8 month_ = month;
-            if (day == 0 || day > days_in_month(year, month))
-                return err(time_error::RangeError);
-            u8 day_ = day;
-            if (hour > 23)
-                return err(time_error::RangeError);
-            u8 hour_ = hour;
-            if (min > 59)
-                return err(time_error::RangeError);
-            u8 min_ = min;
-            if (sec > 59)
-                return err(time_error::RangeError);
-            u8 sec_ = sec;
+            if (month == 0 || month > 12) [[unlikely]]
+                return cold_err(time_error::RangeError);
+            if (day == 0 || day > days_in_month(year, month)) [[unlikely]]
+                return cold_err(time_error::RangeError);
+            if (hour > 23 || min > 59 || sec > 59) [[unlikely]]
+                return cold_err(time_error::RangeError);
 
             i64 days_before_year;
             if (year >= 1970) {
@@ -116,32 +121,31 @@ namespace orc::time {
                 const i64 leaps = leaps_to_1970(year);
                 days_before_year = -(years * 365 + leaps);
             }
-            i64 days_before_month = 0;
-            for (u8 m = 1; m < month_; ++m)
-                days_before_month += static_cast<i64>(days_in_month(year, m));
-            const i64 day_offset = static_cast<i64>(day_) - 1;
-            auto tmp = checked_add(days_before_year, days_before_month);
-            if (!tmp.has_value()) return err(time_error::RangeError);
-            i64 total_days = tmp.value();
-            tmp = checked_add(total_days, day_offset);
-            if (!tmp.has_value()) return err(time_error::RangeError);
-            total_days = tmp.value();
-            tmp = checked_mul(total_days, SECONDS_PER_DAY);
-            if (!tmp.has_value()) return err(time_error::RangeError);
-            i64 seconds = tmp.value();
-            tmp = checked_add(seconds, static_cast<i64>(hour) * 3600);
-            if (!tmp.has_value()) return err(time_error::RangeError);
-            seconds = tmp.value();
-            tmp = checked_add(seconds, static_cast<i64>(min) * 60);
-            if (!tmp.has_value()) return err(time_error::RangeError);
-            seconds = tmp.value();
-            tmp = checked_add(seconds, static_cast<i64>(sec));
-            if (!tmp.has_value()) return err(time_error::RangeError);
-            seconds = tmp.value();
+            const i64 day_offset = static_cast<i64>(day) - 1;
+            ORC_TRY_SOME(month_days, checked_add(days_before_year, days_before_month(year, month)), time_error::RangeError)
+            ORC_TRY_SOME(total_days, checked_add(month_days, day_offset), time_error::RangeError)
+            ORC_TRY_SOME(day_seconds, checked_mul(total_days, SECONDS_PER_DAY), time_error::RangeError)
+            ORC_TRY_SOME(hour_seconds, checked_add(day_seconds, static_cast<i64>(hour) * 3600), time_error::RangeError)
+            ORC_TRY_SOME(min_seconds, checked_add(hour_seconds, static_cast<i64>(min) * 60), time_error::RangeError)
+            ORC_TRY_SOME(seconds, checked_add(min_seconds, static_cast<i64>(sec)), time_error::RangeError)
             return ok(time{seconds});
         }
 
         [[nodiscard]] constexpr auto raw_value() const noexcept -> i64 { return seconds; }
+
+        [[nodiscard]] constexpr auto operator<=>(const time&) const noexcept -> std::strong_ordering = default;
+        [[nodiscard]] constexpr auto operator==(const time&) const noexcept -> bool = default;
+        auto hash(hash::hasher& state) const noexcept -> void { state.write(seconds); }
+
+        /// index of the `bucket`-sized interval since epoch, rounded towards negative infinity
+        [[nodiscard]] constexpr auto bucket(const divisor<i64>& size) const noexcept -> i64 { return size.div_euclid(seconds); }
+        [[nodiscard]] constexpr auto days_since_epoch() const noexcept -> i64 { return bucket(DAY_DIVISOR); }
+        [[nodiscard]] constexpr auto hours_since_epoch() const noexcept -> i64 { return bucket(HOUR_DIVISOR); }
+        [[nodiscard]] constexpr auto minutes_since_epoch() const noexcept -> i64 { return bucket(MINUTE_DIVISOR); }
+        /// start of the `bucket`-sized interval containing this time
+        [[nodiscard]] constexpr auto truncate(const divisor<i64>& size) const noexcept -> time {
+            return time{seconds - size.rem_euclid(seconds)};
+        }
         constexpr auto convert(const timezone self_timezone, const timezone to_timezone){
             const i32 offset_hours = static_cast<i32>(to_timezone) - static_cast<i32>(self_timezone);
             seconds = seconds + static_cast<i64>(offset_hours) * SECONDS_PER_HOUR;
@@ -157,9 +161,8 @@ namespace orc::time {
             return convert(timezone::UTC0, to_timezone);
         }
 
-        friend auto operator<<(std::ostream& os, const time& t) -> std::ostream& {
-            const i64 days_since_epoch = div_euclid(t.seconds, SECONDS_PER_DAY);
-            const i64 secs_of_day = rem_euclid(t.seconds, SECONDS_PER_DAY);
+        auto format_to(format::sink& out) const -> void {
+            const auto [days_since_epoch, secs_of_day] = DAY_DIVISOR.div_rem_euclid(seconds);
 
             i32 year = 1970;
             i64 day_of_year = days_since_epoch;
@@ -177,52 +180,39 @@ namespace orc::time {
                     year -= 1;
                     i64 days_in_prev_year;
                     if (is_leap(year)) { days_in_prev_year = 366; } else { days_in_prev_year = 365; }
-                    if (day_of_year + days_in_prev_year >= 0) {
-                        day_of_year += days_in_prev_year;
-                        break;
-                    }
+                    day_of_year += days_in_prev_year;
+                    if (day_of_year >= 0) break;
                 }
             }
 
-            u8 month = 1;
-            i64 day_idx = day_of_year;
-            for (u8 m = 1; m <= 12; ++m) {
-                const i64 dim = days_in_month(year, m);
-                if (day_idx < dim) {
-                    month = m;
-                    break;
-                }
-                day_idx -= dim;
-            }
-            const i32 day = day_idx + 1;
-            const i32 hour = secs_of_day / 3600;
-            const i32 minute = secs_of_day % 3600 / 60;
-            const i32 second = secs_of_day % 60;
-
-            std::string month_str;
-
-            switch (month) {
-                case 1: month_str = "Jan"; break;
-                case 2: month_str = "Feb"; break;
-                case 3: month_str = "Mar"; break;
-                case 4: month_str = "Apr"; break;
-                case 5: month_str = "May"; break;
-                case 6: month_str = "Jun"; break;
-                case 7: month_str = "Jul"; break;
-                case 8: month_str = "Aug"; break;
-                case 9: month_str = "Sep"; break;
-                case 10: month_str = "Oct"; break;
-                case 11: month_str = "Nov"; break;
-                case 12: month_str = "Dec"; break;
-                default: month_str = "???"; break;
-            }
-
-            os << month_str << " " << day << " " << year << ' ' << std::format("{:02}:{:02}:{:02}", hour, minute, second);
+            i32 month = 1;
+            while (month < 12 && day_of_year >= days_before_month(year, month + 1)) ++month;
+            const i32 day = static_cast<i32>(day_of_year - days_before_month(year, month)) + 1;
+            const auto [hour, secs_of_hour] = HOUR_DIVISOR.div_rem_euclid(secs_of_day);
+            const auto [minute, second] = MINUTE_DIVISOR.div_rem_euclid(secs_of_hour);
+
+            out << MONTH_NAMES[month - 1] << ' ' << day << ' ' << year << ' ';
+            format::format_padded(out, static_cast<u64>(hour), 2);
+            out.put(':');
+            format::format_padded(out, static_cast<u64>(minute), 2);
+            out.put(':');
+            format::format_padded(out, static_cast<u64>(second), 2);
+        }
+        friend auto operator<<(std::ostream& os, const time& t) -> std::ostream& {
+            format::ostream_sink out(os);
+            t.format_to(out);
             return os;
         }
     private:
         i64 seconds;
     };
+
+    /// writes `times[i].bucket(size)` into `out[i]`
+    ORC_API constexpr auto bucket(const std::span<const time> times, const divisor<i64>& size, const std::span<i64> out) -> void {
+        if (out.size() < times.size()) throw std::invalid_argument("span sizes do not match");
+        for (usize i = 0; i < times.size(); ++i)
+            out[i] = times[i].bucket(size);
+    }
     struct ORC_API clockwatch {
 
         static auto start() {
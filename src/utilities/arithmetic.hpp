@@ -1,129 +1,194 @@
 #pragma once
+#include <functional>
+#include <limits>
 #include <optional>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
 #include <ordefs.hpp>
+#include <orconcepts.hpp>
 #include <orc_export.hpp>
 using namespace orc::core::defines;
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_add_overflow) && __has_builtin(__builtin_sub_overflow) && __has_builtin(__builtin_mul_overflow)
+#define ORC_OVERFLOW_BUILTINS
+#endif
+#elif defined(__GNUC__)
+#define ORC_OVERFLOW_BUILTINS
+#endif
 
 namespace orc::utils::arithmetic {
-    template<typename T>
-    requires std::is_integral_v<T>
-    ORC_API constexpr auto add_with_overflow(T left, T right) -> std::pair<T, bool> {
-        T res;
-        if constexpr (std::is_unsigned_v<T>) {
-            res = left + right;
-            if (res < left)
-                return std::make_pair(0, true);
-            return std::make_pair(res, false);
+#pragma push_macro("max")
+#pragma push_macro("min")
+#undef max
+#undef min
+
+    /// branch-free forms of the overflow checks, also used by the span kernels since they vectorize
+    template<core::concepts::integer T>
+    constexpr auto _portable_add_with_overflow(const T left, const T right, T& res) noexcept -> bool {
+        using U = std::make_unsigned_t<T>;
+        res = static_cast<T>(static_cast<U>(left) + static_cast<U>(right));
+        if constexpr (std::is_unsigned_v<T>)
+            return res < left;
+        else
+            return ((left ^ res) & (right ^ res)) < 0;
+    }
+    template<core::concepts::integer T>
+    constexpr auto _portable_sub_with_overflow(const T left, const T right, T& res) noexcept -> bool {
+        using U = std::make_unsigned_t<T>;
+        res = static_cast<T>(static_cast<U>(left) - static_cast<U>(right));
+        if constexpr (std::is_unsigned_v<T>)
+            return left < right;
+        else
+            return ((left ^ right) & (left ^ res)) < 0;
+    }
+    template<core::concepts::integer T>
+    constexpr auto _portable_mul_with_overflow(const T left, const T right, T& res) noexcept -> bool {
+        using U = std::make_unsigned_t<T>;
+        if constexpr (sizeof(T) < sizeof(u64)) {
+            using W = std::conditional_t<std::is_signed_v<T>, i64, u64>;
+            const W wide = static_cast<W>(left) * static_cast<W>(right);
+            res = static_cast<T>(wide);
+            return static_cast<W>(res) != wide;
         } else {
-            if constexpr (std::is_same_v<T, i8>) {
-                if (_add_overflow_i8(0,
-                                     static_cast<i8>(left),
-                                     static_cast<i8>(right),
-                                     &res)
-                        )
-                    return std::make_pair(0, true);
-                return std::make_pair(res, false);
-            } else if constexpr (std::is_same_v<T, i16>) {
-                if (_add_overflow_i16(0,
-                                      static_cast<i16>(left),
-                                      static_cast<i16>(right),
-                                      &res)
-                        )
-                    return std::make_pair(0, true);
-                return std::make_pair(res, false);
-            } else if constexpr (std::is_same_v<T, i32>) {
-                if (_add_overflow_i32(0,
-                                      static_cast<i32>(left),
-                                      static_cast<i32>(right),
-                                      &res)
-                        )
-                    return std::make_pair(0, true);
-                return std::make_pair(res, false);
+            res = static_cast<T>(static_cast<U>(left) * static_cast<U>(right));
+            if constexpr (std::is_unsigned_v<T>) {
+                return left != 0 && res / left != right;
             } else {
-                if (_add_overflow_i64(0,
-                                      static_cast<i64>(left),
-                                      static_cast<i64>(right),
-                                      &res)
-                        )
-                    return std::make_pair(0, true);
-                return std::make_pair(res, false);
+                constexpr T min = std::numeric_limits<T>::min();
+                return left != 0 && ((left == -1 && right == min) ||
+                                     (right == -1 && left == min) ||
+                                     res / left != right);
             }
         }
     }
+
+    /// returns the wrapped result and whether the operation overflowed
+    template<core::concepts::integer T>
+    ORC_API constexpr auto add_with_overflow(const T left, const T right) noexcept -> std::pair<T, bool> {
+        T res;
+#ifdef ORC_OVERFLOW_BUILTINS
+        const bool overflow = __builtin_add_overflow(left, right, &res);
+#else
+        const bool overflow = _portable_add_with_overflow(left, right, res);
+#endif
+        return std::make_pair(res, overflow);
+    }
     template<typename T>
     requires std::is_floating_point_v<T>
     ORC_API constexpr auto add_with_overflow(T left, T right) -> std::pair<T, bool> {
         T res = left + right;
-        if (isinf(res))
-            return std::make_pair(0, true);
-        return std::make_pair(res, false);
+        return std::make_pair(res, res == std::numeric_limits<T>::infinity() || res == -std::numeric_limits<T>::infinity());
+    }
+
+    template<core::concepts::integer T>
+    ORC_API constexpr auto sub_with_overflow(const T left, const T right) noexcept -> std::pair<T, bool> {
+        T res;
+#ifdef ORC_OVERFLOW_BUILTINS
+        const bool overflow = __builtin_sub_overflow(left, right, &res);
+#else
+        const bool overflow = _portable_sub_with_overflow(left, right, res);
+#endif
+        return std::make_pair(res, overflow);
+    }
+    template<typename T>
+    requires std::is_floating_point_v<T>
+    ORC_API constexpr auto sub_with_overflow(T left, T right) -> std::pair<T, bool> {
+        T res = left - right;
+        return std::make_pair(res, res == std::numeric_limits<T>::infinity() || res == -std::numeric_limits<T>::infinity());
+    }
+
+    template<core::concepts::integer T>
+    ORC_API constexpr auto mul_with_overflow(const T left, const T right) noexcept -> std::pair<T, bool> {
+        T res;
+#ifdef ORC_OVERFLOW_BUILTINS
+        const bool overflow = __builtin_mul_overflow(left, right, &res);
+#else
+        const bool overflow = _portable_mul_with_overflow(left, right, res);
+#endif
+        return std::make_pair(res, overflow);
+    }
+    template<typename T>
+    requires std::is_floating_point_v<T>
+    ORC_API constexpr auto mul_with_overflow(T left, T right) -> std::pair<T, bool> {
+        T res = left * right;
+        return std::make_pair(res, res == std::numeric_limits<T>::infinity() || res == -std::numeric_limits<T>::infinity());
     }
 
     template<typename T>
     requires std::is_arithmetic_v<T>
     ORC_API constexpr auto checked_add(const T left, const T right) -> std::optional<T> {
-        if (auto [a, b] = add_with_overflow(left, right); b) return std::make_optional(a);
+        if (auto [a, b] = add_with_overflow(left, right); !b) [[likely]] return a;
         return std::nullopt;
     }
-
     template<typename T>
-    requires std::is_integral_v<T>
-    ORC_API constexpr auto mul_with_overflow(T left, T right) -> std::pair<T, bool> {
-        T res;
-        T dummy;
-        if constexpr (std::is_unsigned_v<T>) {
-            res = left * right;
-            if (res < left)
-                return std::make_pair(0, true);
-            return std::make_pair(res, false);
-        } else {
-            if constexpr (std::is_same_v<T, i8>) {
-                if (_mul_full_overflow_i8(
-                        static_cast<i8>(left),
-                        static_cast<i8>(right),
-                        &res)
-                        )
-                    return std::make_pair(0, true);
-                return std::make_pair(res, false);
-            } else if constexpr (std::is_same_v<T, i16>) {
-
-                if (_mul_full_overflow_i16(
-                        static_cast<i16>(left),
-                        static_cast<i16>(right),
-                        &res,
-                        &dummy)
-                        )
-                    return std::make_pair(0, true);
-                return std::make_pair(res, false);
-            } else if constexpr (std::is_same_v<T, i32>) {
-                if (_mul_full_overflow_i32(
-                        static_cast<i32>(left),
-                        static_cast<i32>(right),
-                        &res,
-                        &dummy)
-                        )
-                    return std::make_pair(0, true);
-                return std::make_pair(res, false);
-            } else {
-                if (_mul_full_overflow_i64(
-                        static_cast<i64>(left),
-                        static_cast<i64>(right),
-                        &res,
-                        &dummy)
-                        )
-                    return std::make_pair(0, true);
-                return std::make_pair(res, false);
-            }
-        }
+    requires std::is_arithmetic_v<T>
+    ORC_API constexpr auto checked_sub(const T left, const T right) -> std::optional<T> {
+        if (auto [a, b] = sub_with_overflow(left, right); !b) [[likely]] return a;
+        return std::nullopt;
     }
     template<typename T>
     requires std::is_arithmetic_v<T>
     ORC_API constexpr auto checked_mul(const T left, const T right) -> std::optional<T> {
-        if (auto [a, b] = mul_with_overflow(left, right); b) return std::make_optional(a);
+        if (auto [a, b] = mul_with_overflow(left, right); !b) [[likely]] return a;
         return std::nullopt;
     }
 
+    template<core::concepts::integer T>
+    ORC_API constexpr auto wrapping_add(const T self, const T rhs) noexcept -> T {
+        return add_with_overflow(self, rhs).first;
+    }
+    template<core::concepts::integer T>
+    ORC_API constexpr auto wrapping_sub(const T self, const T rhs) noexcept -> T {
+        return sub_with_overflow(self, rhs).first;
+    }
+    template<core::concepts::integer T>
+    ORC_API constexpr auto wrapping_mul(const T self, const T rhs) noexcept -> T {
+        return mul_with_overflow(self, rhs).first;
+    }
+    template<typename T>
+    requires std::is_arithmetic_v<T>
+    ORC_API constexpr auto wrapping_abs(const T self) -> T {
+        if constexpr (std::is_floating_point_v<T>) {
+            return self < 0 ? -self : self;
+        } else if constexpr (std::is_signed_v<T>) {
+            return self < 0 ? wrapping_sub(static_cast<T>(0), self) : self;
+        } else {
+            return self;
+        }
+    }
+
+    template<core::concepts::integer T>
+    ORC_API constexpr auto saturating_add(const T self, const T rhs) noexcept -> T {
+        const auto [res, overflow] = add_with_overflow(self, rhs);
+        if (!overflow) [[likely]] return res;
+        if constexpr (std::is_signed_v<T>)
+            if (rhs < 0) return std::numeric_limits<T>::min();
+        return std::numeric_limits<T>::max();
+    }
+    template<core::concepts::integer T>
+    ORC_API constexpr auto saturating_sub(const T self, const T rhs) noexcept -> T {
+        const auto [res, overflow] = sub_with_overflow(self, rhs);
+        if (!overflow) [[likely]] return res;
+        if constexpr (std::is_signed_v<T>)
+            if (rhs < 0) return std::numeric_limits<T>::max();
+        return std::numeric_limits<T>::min();
+    }
+    template<core::concepts::integer T>
+    ORC_API constexpr auto saturating_mul(const T self, const T rhs) noexcept -> T {
+        const auto [res, overflow] = mul_with_overflow(self, rhs);
+        if (!overflow) [[likely]] return res;
+        if constexpr (std::is_signed_v<T>)
+            if ((self < 0) != (rhs < 0)) return std::numeric_limits<T>::min();
+        return std::numeric_limits<T>::max();
+    }
+
     template<typename T>
     requires std::is_arithmetic_v<T>
     ORC_API constexpr auto div_euclid(const T self, const T rhs) -> T {
@@ -139,39 +204,252 @@ namespace orc::utils::arithmetic {
 
     template<typename T>
     requires std::is_arithmetic_v<T>
-    ORC_API constexpr auto wrapping_add(const T self, const T rhs) -> T {
-#pragma push_macro("max")
-#pragma push_macro("min")
-#undef max
-#undef min
-        const T max = std::numeric_limits<T>::max();
-        if (max - self < rhs) {
-            return std::numeric_limits<T>::min() + (max - self - rhs);
+    ORC_API constexpr auto rem_euclid(const T self, const T rhs) -> T {
+        const T r = self % rhs;
+        if (r < 0) {
+            return wrapping_add(r, wrapping_abs(rhs));
         }
-#pragma pop_macro("min")
-#pragma pop_macro("max")
-        return self + rhs;
+        return r;
+
     }
+
+    constexpr usize _SPAN_BLOCK = 256;
+
     template<typename T>
-    requires std::is_arithmetic_v<T>
-    ORC_API constexpr auto wrapping_abs(const T self) -> T {
-        if constexpr (std::is_signed_v<T>) {
-            return std::abs(self);
-        } else {
-            return self;
-        }
+    constexpr auto _check_spans(const std::span<const T> left, const std::span<const T> right, const std::span<T> out) -> void {
+        if (left.size() != right.size() || out.size() < left.size())
+            throw std::invalid_argument("span sizes do not match");
     }
 
     template<typename T>
-    requires std::is_arithmetic_v<T>
-    ORC_API constexpr auto rem_euclid(const T self, const T rhs) -> T {
-        const T r = self % rhs;
-        if (r < 0) {
-            return wrapping_add(r, wrapping_abs(rhs));
+    [[nodiscard]] constexpr auto _overlaps(const std::span<const T> in, const std::span<T> out) noexcept -> bool {
+        if (std::is_constant_evaluated()) return true;
+        const std::less<const T*> before;
+        return before(in.data(), out.data() + out.size()) && before(out.data(), in.data() + in.size());
+    }
+
+    /// runs `op` over whole blocks without branching and only rescans a block that overflowed.
+    /// when `out` overlaps an input the rescan can't recompute, so overflows are recorded as flags instead
+    template<typename T, typename Op>
+    constexpr auto _first_overflow(const std::span<const T> left, const std::span<const T> right, const std::span<T> out, Op op) -> usize {
+        _check_spans(left, right, out);
+        const usize n = left.size();
+        const bool aliased = _overlaps(left, out) || _overlaps(right, out);
+        for (usize base = 0; base < n; base += _SPAN_BLOCK) {
+            const usize len = std::min(_SPAN_BLOCK, n - base);
+            if (aliased) {
+                u8 flags[_SPAN_BLOCK] = {};
+                u8 any = 0;
+                for (usize i = 0; i < len; ++i) {
+                    flags[i] = static_cast<u8>(op(left[base + i], right[base + i], out[base + i]));
+                    any |= flags[i];
+                }
+                if (any != 0) [[unlikely]] {
+                    for (usize i = 0;; ++i)
+                        if (flags[i] != 0) return base + i;
+                }
+                continue;
+            }
+            bool any = false;
+            for (usize i = 0; i < len; ++i)
+                any |= op(left[base + i], right[base + i], out[base + i]);
+            if (any) [[unlikely]] {
+                for (usize i = 0; i < len; ++i) {
+                    T tmp;
+                    if (op(left[base + i], right[base + i], tmp)) return base + i;
+                }
+            }
         }
-        return r;
+        return n;
+    }
+    template<typename T, typename Op>
+    constexpr auto _overflow_mask(const std::span<const T> left, const std::span<const T> right, const std::span<T> out, const std::span<u64> mask, Op op) -> bool {
+        _check_spans(left, right, out);
+        const usize n = left.size();
+        if (mask.size() < (n + 63) / 64)
+            throw std::invalid_argument("mask is too small");
+        u64 any = 0;
+        for (usize base = 0; base < n; base += 64) {
+            const usize len = std::min<usize>(64, n - base);
+            u64 word = 0;
+            for (usize i = 0; i < len; ++i)
+                word |= static_cast<u64>(op(left[base + i], right[base + i], out[base + i])) << i;
+            mask[base / 64] = word;
+            any |= word;
+        }
+        return any != 0;
+    }
+    template<core::concepts::integer T>
+    constexpr auto _span_mul_with_overflow(const T left, const T right, T& res) noexcept -> bool {
+        if constexpr (sizeof(T) < sizeof(u64)) {
+            return _portable_mul_with_overflow(left, right, res);
+        } else {
+            // there is no 64x64 high multiply in SIMD, so use the single-instruction scalar form
+            const auto [r, overflow] = mul_with_overflow(left, right);
+            res = r;
+            return overflow;
+        }
+    }
 
+    /// element-wise `left + right` into `out`,
+    /// returns the index of the first overflowing element or `left.size()` when none overflowed
+    template<core::concepts::integer T>
+    ORC_API constexpr auto checked_add(const std::type_identity_t<std::span<const T>> left, const std::type_identity_t<std::span<const T>> right, const std::span<T> out) -> usize {
+        return _first_overflow<T>(left, right, out, _portable_add_with_overflow<T>);
+    }
+    template<core::concepts::integer T>
+    ORC_API constexpr auto checked_sub(const std::type_identity_t<std::span<const T>> left, const std::type_identity_t<std::span<const T>> right, const std::span<T> out) -> usize {
+        return _first_overflow<T>(left, right, out, _portable_sub_with_overflow<T>);
+    }
+    template<core::concepts::integer T>
+    ORC_API constexpr auto checked_mul(const std::type_identity_t<std::span<const T>> left, const std::type_identity_t<std::span<const T>> right, const std::span<T> out) -> usize {
+        return _first_overflow<T>(left, right, out, _span_mul_with_overflow<T>);
     }
-}
 
+    /// element-wise `left + right` into `out`, bit `i % 64` of `mask[i / 64]` is set for every overflowing element
+    template<core::concepts::integer T>
+    ORC_API constexpr auto checked_add_mask(const std::type_identity_t<std::span<const T>> left, const std::type_identity_t<std::span<const T>> right, const std::span<T> out, const std::span<u64> mask) -> bool {
+        return _overflow_mask<T>(left, right, out, mask, _portable_add_with_overflow<T>);
+    }
+    template<core::concepts::integer T>
+    ORC_API constexpr auto checked_sub_mask(const std::type_identity_t<std::span<const T>> left, const std::type_identity_t<std::span<const T>> right, const std::span<T> out, const std::span<u64> mask) -> bool {
+        return _overflow_mask<T>(left, right, out, mask, _portable_sub_with_overflow<T>);
+    }
+    template<core::concepts::integer T>
+    ORC_API constexpr auto checked_mul_mask(const std::type_identity_t<std::span<const T>> left, const std::type_identity_t<std::span<const T>> right, const std::span<T> out, const std::span<u64> mask) -> bool {
+        return _overflow_mask<T>(left, right, out, mask, _span_mul_with_overflow<T>);
+    }
 
+    template<core::concepts::integer T>
+    ORC_API constexpr auto wrapping_add(const std::type_identity_t<std::span<const T>> left, const std::type_identity_t<std::span<const T>> right, const std::span<T> out) -> void {
+        _check_spans<T>(left, right, out);
+        for (usize i = 0; i < left.size(); ++i)
+            static_cast<void>(_portable_add_with_overflow(left[i], right[i], out[i]));
+    }
+    template<core::concepts::integer T>
+    ORC_API constexpr auto wrapping_sub(const std::type_identity_t<std::span<const T>> left, const std::type_identity_t<std::span<const T>> right, const std::span<T> out) -> void {
+        _check_spans<T>(left, right, out);
+        for (usize i = 0; i < left.size(); ++i)
+            static_cast<void>(_portable_sub_with_overflow(left[i], right[i], out[i]));
+    }
+    template<core::concepts::integer T>
+    ORC_API constexpr auto wrapping_mul(const std::type_identity_t<std::span<const T>> left, const std::type_identity_t<std::span<const T>> right, const std::span<T> out) -> void {
+        using U = std::make_unsigned_t<T>;
+        _check_spans<T>(left, right, out);
+        for (usize i = 0; i < left.size(); ++i)
+            out[i] = static_cast<T>(static_cast<U>(left[i]) * static_cast<U>(right[i]));
+    }
+
+    template<core::concepts::integer T>
+    ORC_API constexpr auto saturating_add(const std::type_identity_t<std::span<const T>> left, const std::type_identity_t<std::span<const T>> right, const std::span<T> out) -> void {
+        _check_spans<T>(left, right, out);
+        for (usize i = 0; i < left.size(); ++i) {
+            T res;
+            const bool overflow = _portable_add_with_overflow(left[i], right[i], res);
+            T sat = std::numeric_limits<T>::max();
+            if constexpr (std::is_signed_v<T>)
+                sat = right[i] < 0 ? std::numeric_limits<T>::min() : sat;
+            out[i] = overflow ? sat : res;
+        }
+    }
+    template<core::concepts::integer T>
+    ORC_API constexpr auto saturating_sub(const std::type_identity_t<std::span<const T>> left, const std::type_identity_t<std::span<const T>> right, const std::span<T> out) -> void {
+        _check_spans<T>(left, right, out);
+        for (usize i = 0; i < left.size(); ++i) {
+            T res;
+            const bool overflow = _portable_sub_with_overflow(left[i], right[i], res);
+            T sat = std::numeric_limits<T>::min();
+            if constexpr (std::is_signed_v<T>)
+                sat = right[i] < 0 ? std::numeric_limits<T>::max() : sat;
+            out[i] = overflow ? sat : res;
+        }
+    }
+    template<core::concepts::integer T>
+    ORC_API constexpr auto saturating_mul(const std::type_identity_t<std::span<const T>> left, const std::type_identity_t<std::span<const T>> right, const std::span<T> out) -> void {
+        _check_spans<T>(left, right, out);
+        for (usize i = 0; i < left.size(); ++i) {
+            T res;
+            const bool overflow = _span_mul_with_overflow(left[i], right[i], res);
+            T sat = std::numeric_limits<T>::max();
+            if constexpr (std::is_signed_v<T>)
+                sat = (left[i] < 0) != (right[i] < 0) ? std::numeric_limits<T>::min() : sat;
+            out[i] = overflow ? sat : res;
+        }
+    }
+
+    template<core::concepts::integer T>
+    ORC_API constexpr auto div_euclid(const std::type_identity_t<std::span<const T>> self, const T rhs, const std::span<T> out) -> void {
+        if (out.size() < self.size()) throw std::invalid_argument("span sizes do not match");
+        for (usize i = 0; i < self.size(); ++i)
+            out[i] = div_euclid(self[i], rhs);
+    }
+    template<core::concepts::integer T>
+    ORC_API constexpr auto rem_euclid(const std::type_identity_t<std::span<const T>> self, const T rhs, const std::span<T> out) -> void {
+        if (out.size() < self.size()) throw std::invalid_argument("span sizes do not match");
+        for (usize i = 0; i < self.size(); ++i)
+            out[i] = rem_euclid(self[i], rhs);
+    }
+
+    /// exact sum of `values`, `nullopt` when it does not fit into `T`.
+    /// every lane counts how many times its partial sum wrapped, so the result only depends
+    /// on the mathematical sum and not on the (vectorized) order of additions
+    template<core::concepts::integer T>
+    ORC_API constexpr auto checked_sum(const std::span<const T> values) -> std::optional<T> {
+        constexpr usize LANES = 8;
+        T sums[LANES] = {};
+        i64 wraps[LANES] = {};
+        const usize n = values.size();
+        usize i = 0;
+#if defined(__AVX2__)
+        if constexpr (std::is_same_v<T, i64>) {
+            if (!std::is_constant_evaluated()) {
+                // same lanes as below, the wrap counter is decremented for negative addends and incremented otherwise
+                const __m256i zero = _mm256_setzero_si256();
+                const __m256i one = _mm256_set1_epi64x(1);
+                __m256i sum_lo = zero, sum_hi = zero, wraps_lo = zero, wraps_hi = zero;
+                const auto step = [&](__m256i& sum, __m256i& wrap, const __m256i v) {
+                    const __m256i res = _mm256_add_epi64(sum, v);
+                    const __m256i overflow = _mm256_cmpgt_epi64(zero, _mm256_and_si256(_mm256_xor_si256(sum, res), _mm256_xor_si256(v, res)));
+                    const __m256i direction = _mm256_or_si256(_mm256_cmpgt_epi64(zero, v), one);
+                    wrap = _mm256_add_epi64(wrap, _mm256_and_si256(overflow, direction));
+                    sum = res;
+                };
+                for (; i + LANES <= n; i += LANES) {
+                    step(sum_lo, wraps_lo, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values.data() + i)));
+                    step(sum_hi, wraps_hi, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values.data() + i + 4)));
+                }
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(sums), sum_lo);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(sums + 4), sum_hi);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(wraps), wraps_lo);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(wraps + 4), wraps_hi);
+            }
+        }
+#endif
+        for (; i + LANES <= n; i += LANES) {
+            for (usize j = 0; j < LANES; ++j) {
+                T res;
+                const bool overflow = _portable_add_with_overflow(sums[j], values[i + j], res);
+                wraps[j] += overflow ? (std::is_signed_v<T> && values[i + j] < 0 ? -1 : 1) : 0;
+                sums[j] = res;
+            }
+        }
+        for (; i < n; ++i) {
+            T res;
+            const bool overflow = _portable_add_with_overflow(sums[0], values[i], res);
+            wraps[0] += overflow ? (std::is_signed_v<T> && values[i] < 0 ? -1 : 1) : 0;
+            sums[0] = res;
+        }
+        T total = sums[0];
+        i64 total_wraps = wraps[0];
+        for (usize j = 1; j < LANES; ++j) {
+            T res;
+            const bool overflow = _portable_add_with_overflow(total, sums[j], res);
+            total_wraps += wraps[j] + (overflow ? (std::is_signed_v<T> && sums[j] < 0 ? -1 : 1) : 0);
+            total = res;
+        }
+        if (total_wraps != 0) [[unlikely]] return std::nullopt;
+        return total;
+    }
+#pragma pop_macro("min")
+#pragma pop_macro("max")
+}
@@ -0,0 +1,151 @@
+#pragma once
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <ordefs.hpp>
+#include <orconcepts.hpp>
+#include <orc_export.hpp>
+#if defined(_MSC_VER) && defined(_M_X64) && !defined(__SIZEOF_INT128__)
+#include <intrin.h>
+#endif
+using namespace orc::core::defines;
+
+namespace orc::utils::arithmetic {
+
+    /// high 64 bits of `left * right`
+    ORC_API constexpr auto mul_high(const u64 left, const u64 right) noexcept -> u64 {
+#ifdef __SIZEOF_INT128__
+        return static_cast<u64>((static_cast<unsigned __int128>(left) * right) >> 64);
+#else
+#if defined(_MSC_VER) && defined(_M_X64)
+        if (!std::is_constant_evaluated()) return __umulh(left, right);
+#endif
+        const u64 l_lo = left & 0xFFFFFFFF, l_hi = left >> 32;
+        const u64 r_lo = right & 0xFFFFFFFF, r_hi = right >> 32;
+        const u64 lo_lo = l_lo * r_lo;
+        const u64 mid1 = l_hi * r_lo + (lo_lo >> 32);
+        const u64 mid2 = l_lo * r_hi + (mid1 & 0xFFFFFFFF);
+        return l_hi * r_hi + (mid1 >> 32) + (mid2 >> 32);
+#endif
+    }
+
+    /// `(high * 2^64 + low) / d`, requires `high < d`
+    constexpr auto _div_128_by_64(u64 high, u64 low, const u64 d) noexcept -> u64 {
+#ifdef __SIZEOF_INT128__
+        return static_cast<u64>(((static_cast<unsigned __int128>(high) << 64) | low) / d);
+#else
+        u64 q = 0;
+        for (i32 i = 0; i < 64; ++i) {
+            const bool carry = high >> 63;
+            high = (high << 1) | (low >> 63);
+            low <<= 1;
+            q <<= 1;
+            if (carry || high >= d) {
+                high -= d;
+                q |= 1;
+            }
+        }
+        return q;
+#endif
+    }
+
+    /// precomputed divisor which replaces the hardware divide by a multiply and shifts.
+    /// division and remainder follow euclidean semantics, so the remainder is never negative
+    template<core::concepts::integer T>
+    class ORC_API divisor {
+    public:
+        constexpr explicit divisor(const T rhs) : d(rhs), abs_d(magnitude(rhs)) {
+            if (rhs == 0) throw std::invalid_argument("division by zero");
+            if (abs_d == 1) {
+                kind = kind_t::One;
+            } else if (abs_d > (1ull << 63)) {
+                kind = kind_t::Large;
+            } else {
+                // round-up method: q = (t + ((n - t) >> 1)) >> (log - 1), t = mul_high(magic, n)
+                kind = kind_t::Magic;
+                u8 log = 0;
+                while ((1ull << log) < abs_d) ++log;
+                shift = static_cast<u8>(log - 1);
+                magic = _div_128_by_64((1ull << log) - abs_d, 0, abs_d) + 1;
+            }
+            if constexpr (std::is_signed_v<T>)
+                negative = rhs < 0 ? ~0ull : 0;
+        }
+
+        [[nodiscard]] constexpr auto value() const noexcept -> T { return d; }
+
+        [[nodiscard]] constexpr auto div_euclid(const T self) const noexcept -> T {
+            if constexpr (std::is_unsigned_v<T>) {
+                return static_cast<T>(divide(self));
+            } else {
+                // floor division of the magnitude by flipping the bits of negative values, then the divisor's sign
+                const u64 sign = static_cast<u64>(static_cast<i64>(self) >> 63);
+                const u64 q = divide(static_cast<u64>(static_cast<i64>(self)) ^ sign) ^ sign;
+                return static_cast<T>((q ^ negative) - negative);
+            }
+        }
+        [[nodiscard]] constexpr auto rem_euclid(const T self) const noexcept -> T {
+            return div_rem_euclid(self).second;
+        }
+        [[nodiscard]] constexpr auto div_rem_euclid(const T self) const noexcept -> std::pair<T, T> {
+            const T q = div_euclid(self);
+            using U = std::make_unsigned_t<T>;
+            const T r = static_cast<T>(static_cast<U>(self) - static_cast<U>(q) * static_cast<U>(d));
+            return std::make_pair(q, r);
+        }
+
+    private:
+        enum class kind_t : u8 {
+            One,
+            Magic,
+            Large,
+        };
+
+        T d;
+        u64 abs_d;
+        u64 magic = 0;
+        u64 negative = 0;
+        u8 shift = 0;
+        kind_t kind = kind_t::One;
+
+        [[nodiscard]] static constexpr auto magnitude(const T value) noexcept -> u64 {
+            if constexpr (std::is_signed_v<T>)
+                return value < 0 ? 0 - static_cast<u64>(static_cast<i64>(value)) : static_cast<u64>(value);
+            else
+                return static_cast<u64>(value);
+        }
+        [[nodiscard]] constexpr auto divide(const u64 n) const noexcept -> u64 {
+            switch (kind) {
+                case kind_t::Magic: {
+                    const u64 t = mul_high(magic, n);
+                    return (t + ((n - t) >> 1)) >> shift;
+                }
+                case kind_t::Large: return n >= abs_d ? 1 : 0;
+                default: return n;
+            }
+        }
+    };
+
+    template<core::concepts::integer T>
+    ORC_API constexpr auto div_euclid(const T self, const divisor<T>& rhs) noexcept -> T {
+        return rhs.div_euclid(self);
+    }
+    template<core::concepts::integer T>
+    ORC_API constexpr auto rem_euclid(const T self, const divisor<T>& rhs) noexcept -> T {
+        return rhs.rem_euclid(self);
+    }
+
+    template<core::concepts::integer T>
+    ORC_API constexpr auto div_euclid(const std::type_identity_t<std::span<const T>> self, const divisor<T>& rhs, const std::span<T> out) -> void {
+        if (out.size() < self.size()) throw std::invalid_argument("span sizes do not match");
+        for (usize i = 0; i < self.size(); ++i)
+            out[i] = rhs.div_euclid(self[i]);
+    }
+    template<core::concepts::integer T>
+    ORC_API constexpr auto rem_euclid(const std::type_identity_t<std::span<const T>> self, const divisor<T>& rhs, const std::span<T> out) -> void {
+        if (out.size() < self.size()) throw std::invalid_argument("span sizes do not match");
+        for (usize i = 0; i < self.size(); ++i)
+            out[i] = rhs.rem_euclid(self[i]);
+    }
+}